@@ -0,0 +1,205 @@
+/** *****************************************************************************
+*   @copyright :  Copyright (C) 2026 Qin ZhaoYu. All rights reserved.
+*
+*   @author    :  Qin ZhaoYu.
+*   @see       :  https://github.com/QINZHAOYU
+*   @brief     :  To benchmark throughput of DataSmoother on a long series.
+*
+*   usage: bench_DataSmoothingAlgo [size=10000000] [repeatNum=5]
+*
+*   Each method prints one line of its best throughput in samples per second
+*   for each supported instruction set, with a window copying smoother as
+*   reference.
+*
+** ******************************************************************************/
+
+#include "common/CommHeader.hpp"
+#include "common/CommConsts.hpp"
+#include "modules/DataSmoothingAlgo.hpp"
+#include <random>
+#include <functional>
+#include <cmath>
+
+using namespace ccb;
+
+
+/// reference smoother copying each window into a vector, as cubic N7 before
+/// kernels read windows in place.
+void copyingSmoothN7(const VecDbl &orig, VecDbl &res)
+{
+	static const VecDbl args = {-2.0, 3.0, 6.0, 7.0, 6.0, 3.0, -2.0, 21.0};
+	res.clear();
+	VecDbl elems;
+	res.insert(res.end(), orig.begin(), orig.begin() + 3);
+	for (size_t i = 3; i + 3 < orig.size(); ++i)
+	{
+		elems.assign(orig.begin() + i - 3, orig.begin() + i + 4);
+		double val = 0.0;
+		for (size_t j = 0; j < elems.size(); ++j)
+		{
+			val += args[j] * elems[j];
+		}
+		res.push_back(val / args.back());
+	}
+	res.insert(res.end(), orig.end() - 3, orig.end());
+}
+
+
+int main(int argc, char *argv[])
+{
+	size_t size = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+	int repeatNum = (argc > 2) ? std::atoi(argv[2]) : 5;
+	size = (std::max)(size, size_t(7));
+
+	std::mt19937 gen(2026);
+	std::normal_distribution<double> noise(0.0, 1.0);
+	VecDbl orig(size), res(size);
+	for (size_t i = 0; i < size; ++i)
+	{
+		orig[i] = std::sin(i * 1.0e-3) + 0.1 * noise(gen);
+	}
+
+	// best of repeats, result is preallocated.
+	double checksum = 0.0;
+	auto run = [&](const string & name, const std::function<void()> &smooth)
+	{
+		double best = _DBL_MAX;
+		for (int i = 0; i < repeatNum; ++i)
+		{
+			auto start = steady_clock::now();
+			smooth();
+			best = (std::min)(best, duration<double>(steady_clock::now() - start).count());
+		}
+		checksum += res[size / 2];
+		cout << name << ", " << size / best << " samples/s" << endl;
+	};
+
+	cout << "size: " << size << endl;
+	run("copying cubic N7", [&]()
+	{
+		copyingSmoothN7(orig, res);
+	});
+
+	const char *names[] = {"linear N3", "linear N5", "linear N7", "quadratic N5",
+	                       "quadratic N7", "cubic N5", "cubic N7"
+	                      };
+	const char *levels[] = {"scalar", "sse2", "avx2", "avx512"};
+	SimdLevel supported = DataSmoother::simdLevel();
+	for (int m = 0; m <= static_cast<int>(SmoothMethod::CubicN7); ++m)
+	{
+		for (int level = 0; level <= static_cast<int>(supported); ++level)
+		{
+			DataSmoother::setSimdLevel(static_cast<SimdLevel>(level));
+			run(string(names[m]) + ", " + levels[level], [&]()
+			{
+				DataSmoother::smooth(DataSmoother::filter(static_cast<SmoothMethod>(m)),
+				                     orig.data(), size, res.data());
+			});
+		}
+	}
+	DataSmoother::setSimdLevel(supported);
+
+	// Savitzky-Golay filters of wide windows, with weights cached by first run.
+	const int sgFilters[][3] = {{11, 2, 0}, {21, 4, 0}, {21, 4, 1}, {101, 6, 0}};
+	for (const auto &sg : sgFilters)
+	{
+		run("savitzky-golay N" + std::to_string(sg[0]) + " order " + std::to_string(sg[1])
+		    + " deriv " + std::to_string(sg[2]) + ", " + levels[static_cast<int>(supported)], [&]()
+		{
+			DataSmoother::savitzkyGolaySmooth(orig.data(), size, res.data(), sg[0], sg[1], sg[2]);
+		});
+	}
+	// stream of chunks, results written back to back.
+	for (size_t chunk : {64, 4096})
+	{
+		run("stream cubic N7 by chunks of " + std::to_string(chunk), [&]()
+		{
+			StreamSmoother smoother(SmoothMethod::CubicN7);
+			size_t written = 0;
+			for (size_t pos = 0; pos < size; pos += chunk)
+			{
+				written += smoother.push(orig.data() + pos, (std::min)(chunk, size - pos),
+				                         res.data() + written);
+			}
+			smoother.flush(res.data() + written);
+		});
+	}
+	// chunks of series over threads.
+	for (int threadNum : {1, 2, 4, 0})
+	{
+		string threads = (threadNum == 1) ? "1 thread"
+		                 : (threadNum > 0) ? std::to_string(threadNum) + " threads" : "all threads";
+		run("cubic N7 by " + threads, [&]()
+		{
+			DataSmoother::smooth(DataSmoother::filter(SmoothMethod::CubicN7), orig.data(), size,
+			                     res.data(), threadNum);
+		});
+	}
+
+	// moving average by running sum, and by convolution up to its widest window.
+	for (int width : {3, 7, 101, 1001, 10001})
+	{
+		run("moving average N" + std::to_string(width), [&]()
+		{
+			DataSmoother::movingAverage(orig.data(), size, res.data(), width);
+		});
+		if (width <= SG_MAX_WIDTH)
+		{
+			run("savitzky-golay N" + std::to_string(width) + " order 1", [&]()
+			{
+				DataSmoother::savitzkyGolaySmooth(orig.data(), size, res.data(), width, 1);
+			});
+		}
+	}
+
+	// repeated passes, one after another or fused by tiles.
+	VecDbl temp(size);
+	for (int passNum : {3, 5})
+	{
+		run("linear N5 " + std::to_string(passNum) + " passes one after another", [&]()
+		{
+			DataSmoother::linearSmoothN5(orig.data(), size, res.data());
+			for (int p = 1; p < passNum; ++p)
+			{
+				temp.swap(res);
+				DataSmoother::linearSmoothN5(temp.data(), size, res.data());
+			}
+		});
+		run("linear N5 " + std::to_string(passNum) + " passes fused", [&]()
+		{
+			DataSmoother::smoothRepeatedly(DataSmoother::filter(SmoothMethod::LinearN5), passNum,
+			                               orig.data(), size, res.data());
+		});
+	}
+
+	// channels of the same series, smoothed one by one or together.
+	const size_t channelNum = 1000, length = size / channelNum;
+	VecDbl channel(length), channelRes;
+	run("cubic N7 of " + std::to_string(channelNum) + " channels one by one", [&]()
+	{
+		for (size_t c = 0; c < channelNum; ++c)
+		{
+			channel.assign(orig.begin() + c * length, orig.begin() + (c + 1) * length);
+			DataSmoother::cubicSmoothN7(channel, channelRes);
+			std::copy(channelRes.begin(), channelRes.end(), res.begin() + c * length);
+		}
+	});
+	const SmoothFilter &cubicN7 = DataSmoother::filter(SmoothMethod::CubicN7);
+	for (int threadNum : {1, 0})
+	{
+		string threads = (threadNum == 1) ? ", 1 thread" : ", all threads";
+		run("cubic N7 of planar channels" + threads, [&]()
+		{
+			DataSmoother::smoothChannels(cubicN7, orig.data(), length, channelNum,
+			                             ChannelLayout::Planar, res.data(), threadNum);
+		});
+		run("cubic N7 of interleaved channels" + threads, [&]()
+		{
+			DataSmoother::smoothChannels(cubicN7, orig.data(), length, channelNum,
+			                             ChannelLayout::Interleaved, res.data(), threadNum);
+		});
+	}
+	cout << "checksum: " << checksum << endl;
+
+	return 0;
+}
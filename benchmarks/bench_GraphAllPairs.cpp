@@ -0,0 +1,62 @@
+/** *****************************************************************************
+*   @copyright :  Copyright (C) 2026 Qin ZhaoYu. All rights reserved.
+*
+*   @author    :  Qin ZhaoYu.
+*   @see       :  https://github.com/QINZHAOYU
+*   @brief     :  To benchmark all pairs shortest pathes against repeated Dijkstra.
+*
+*   usage: bench_GraphAllPairs [verNum=2000] [degree=8] [threadNum=0]
+*
+** ******************************************************************************/
+
+#include "common/CommHeader.hpp"
+#include "modules/GraphAllPairs.hpp"
+#include <random>
+#include <cmath>
+
+using namespace ccb;
+
+
+int main(int argc, char *argv[])
+{
+	int verNum = (argc > 1) ? std::atoi(argv[1]) : 2000;
+	int degree = (argc > 2) ? std::atoi(argv[2]) : 8;
+	int threadNum = (argc > 3) ? std::atoi(argv[3]) : 0;
+
+	std::mt19937 gen(2026);
+	DirectedGraphHandler::Graph graph;
+	for (int i = 0; i < verNum * degree; ++i)
+	{
+		graph.emplace_back(std::to_string(gen() % verNum), std::to_string(gen() % verNum),
+		                   static_cast<double>(gen() % 10000) / 16.0);
+	}
+	DirectedGraphHandler grapher;
+	grapher.setGraph(graph);
+	ShortestPathEngine engine = grapher.getQueryEngine();
+	int size = engine.graph().verticeNum();
+
+	auto start = steady_clock::now();
+	VecDbl dist;
+	grapher.runFloydWarshallAlgo(dist, threadNum);
+	double fwSeconds = duration<double>(steady_clock::now() - start).count();
+
+	// one full shortest path tree per source vertice.
+	start = steady_clock::now();
+	DijkstraWorkspace workspace;
+	double maxError = 0.0;
+	for (int i = 0; i < size; ++i)
+	{
+		engine.DijkstraAlgo(i, -1, workspace);
+		for (int j = 0; j < size; ++j)
+		{
+			maxError = (std::max)(maxError, std::fabs(dist[i * size + j] - workspace.dist[j]));
+		}
+	}
+	double dijkstraSeconds = duration<double>(steady_clock::now() - start).count();
+
+	cout << "vertices: " << size << ", edges: " << engine.graph().edgeNum() << endl;
+	cout << "blocked Floyd-Warshall: " << fwSeconds * 1000.0 << " ms" << endl;
+	cout << "repeated Dijkstra(serial): " << dijkstraSeconds * 1000.0 << " ms" << endl;
+	cout << "max difference: " << maxError << endl;
+	return 0;
+}
@@ -0,0 +1,97 @@
+/** *****************************************************************************
+*   @copyright :  Copyright (C) 2026 Qin ZhaoYu. All rights reserved.
+*
+*   @author    :  Qin ZhaoYu.
+*   @see       :  https://github.com/QINZHAOYU
+*   @brief     :  To benchmark throughput of loading graph from files.
+*
+*   usage: bench_GraphFileIO [edgeNum=2000000] [threadNum=0]
+*
+** ******************************************************************************/
+
+#include "common/CommHeader.hpp"
+#include "modules/GraphFileIO.hpp"
+#include <fstream>
+#include <random>
+#include <cstdio>
+
+using namespace ccb;
+
+
+int main(int argc, char *argv[])
+{
+	int edgeNum = (argc > 1) ? std::atoi(argv[1]) : 2000000;
+	int threadNum = (argc > 2) ? std::atoi(argv[2]) : 0;
+	int verNum = (std::max)(1, edgeNum / 8);
+
+	// random graph written as text and binary edge lists.
+	std::mt19937 gen(2026);
+	vector<CsrEdge> edges(edgeNum);
+	{
+		std::ofstream out("bench_edges.csv");
+		for (auto &edge : edges)
+		{
+			edge = {static_cast<int>(gen() % verNum), static_cast<int>(gen() % verNum),
+			        static_cast<double>(gen() % 10000) / 16.0
+			       };
+			out << edge.beg << ',' << edge.end << ',' << edge.weight << '\n';
+		}
+	}
+	EdgeListLoader::saveBinary("bench_edges.bin", edges);
+	vector<CsrEdge>().swap(edges);
+
+	auto measure = [threadNum, edgeNum](const string & file, const string & name)
+	{
+		auto start = steady_clock::now();
+		DirectedGraphHandler grapher;
+		bool status = grapher.loadGraph(file, threadNum);
+		double seconds = duration<double>(steady_clock::now() - start).count();
+
+		cout << name << ": " << (status ? "ok" : "failed")
+		     << ", " << seconds * 1000.0 << " ms, "
+		     << static_cast<double>(edgeNum) / seconds << " edges/s" << endl;
+	};
+
+	// baseline: parse lines into string tuples and `setGraph()`.
+	{
+		auto start = steady_clock::now();
+		DirectedGraphHandler::Graph tuples;
+		std::ifstream in("bench_edges.csv");
+		string beg, end, value;
+		while (std::getline(in, beg, ',') && std::getline(in, end, ',')
+		        && std::getline(in, value))
+		{
+			tuples.emplace_back(beg, end, std::stod(value));
+		}
+		DirectedGraphHandler grapher;
+		grapher.setGraph(tuples);
+		double seconds = duration<double>(steady_clock::now() - start).count();
+
+		cout << "setGraph(tuples): " << seconds * 1000.0 << " ms, "
+		     << static_cast<double>(edgeNum) / seconds << " edges/s" << endl;
+	}
+
+	measure("bench_edges.csv", "loadGraph(text)");
+	measure("bench_edges.bin", "loadGraph(binary)");
+
+	// cold start from snapshot, with arrays used in place of mapped file.
+	{
+		DirectedGraphHandler grapher;
+		grapher.loadGraph("bench_edges.bin", threadNum);
+		grapher.saveSnapshot("bench_graph.bin");
+	}
+	{
+		auto start = steady_clock::now();
+		DirectedGraphHandler grapher;
+		bool status = grapher.loadSnapshot("bench_graph.bin");
+		double seconds = duration<double>(steady_clock::now() - start).count();
+
+		cout << "loadSnapshot(): " << (status ? "ok" : "failed")
+		     << ", " << seconds * 1000.0 << " ms" << endl;
+	}
+
+	std::remove("bench_edges.csv");
+	std::remove("bench_edges.bin");
+	std::remove("bench_graph.bin");
+	return 0;
+}
@@ -0,0 +1,88 @@
+/** *****************************************************************************
+*   @copyright :  Copyright (C) 2026 Qin ZhaoYu. All rights reserved.
+*
+*   @author    :  Qin ZhaoYu.
+*   @see       :  https://github.com/QINZHAOYU
+*   @brief     :  To benchmark top k shortest pathes on a large sparse graph.
+*
+*   usage: bench_GraphKShortestPath [side=300] [queryNum=20] [maxK=20]
+*
+** ******************************************************************************/
+
+#include "common/CommHeader.hpp"
+#include "modules/GraphKShortestPath.hpp"
+#include <random>
+
+using namespace ccb;
+
+
+int main(int argc, char *argv[])
+{
+	int side = (argc > 1) ? std::atoi(argv[1]) : 300;
+	int queryNum = (argc > 2) ? std::atoi(argv[2]) : 20;
+	int maxK = (argc > 3) ? std::atoi(argv[3]) : 20;
+
+	// road-like grid with random two-way edges, many near-equal alternatives.
+	std::mt19937 gen(2026);
+	DirectedGraphHandler::Graph graph;
+	auto name = [side](int row, int col)
+	{
+		return std::to_string(row * side + col);
+	};
+	for (int row = 0; row < side; ++row)
+	{
+		for (int col = 0; col < side; ++col)
+		{
+			if (col + 1 < side)
+			{
+				double value = 10.0 + gen() % 100;
+				graph.emplace_back(name(row, col), name(row, col + 1), value);
+				graph.emplace_back(name(row, col + 1), name(row, col), value);
+			}
+			if (row + 1 < side)
+			{
+				double value = 10.0 + gen() % 100;
+				graph.emplace_back(name(row, col), name(row + 1, col), value);
+				graph.emplace_back(name(row + 1, col), name(row, col), value);
+			}
+		}
+	}
+	DirectedGraphHandler grapher;
+	grapher.setGraph(graph);
+	ShortestPathEngine engine = grapher.getQueryEngine();
+	int size = engine.graph().verticeNum();
+	cout << "vertices: " << size << ", edges: " << engine.graph().edgeNum() << endl;
+
+	vector<array<int, 2>> pairs(queryNum);
+	for (auto &pair : pairs)
+	{
+		pair = {static_cast<int>(gen() % size), static_cast<int>(gen() % size)};
+	}
+
+	// reverse tree of each end vertice is searched by the first query and
+	// reused over k, so it is timed on its own line before the k curve.
+	vector<KShortestPathes> searchers(queryNum, KShortestPathes(engine));
+	vector<VecInt> routes;
+	VecDbl lengths;
+	auto start = steady_clock::now();
+	for (int i = 0; i < queryNum; ++i)
+	{
+		searchers[i].YenAlgo(pairs[i][0], pairs[i][1], 1, routes, lengths);
+	}
+	double seconds = duration<double>(steady_clock::now() - start).count();
+	cout << "first query with reverse tree, " << seconds * 1000.0 / queryNum << " ms" << endl;
+
+	cout << "k, ms per query" << endl;
+	for (int k = 1; k <= maxK; ++k)
+	{
+		start = steady_clock::now();
+		for (int i = 0; i < queryNum; ++i)
+		{
+			searchers[i].YenAlgo(pairs[i][0], pairs[i][1], k, routes, lengths);
+		}
+		seconds = duration<double>(steady_clock::now() - start).count();
+		cout << k << ", " << seconds * 1000.0 / queryNum << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,308 @@
+/** *****************************************************************************
+*   @copyright :  Copyright (C) 2026 Qin ZhaoYu. All rights reserved.
+*
+*   @author    :  Qin ZhaoYu.
+*   @see       :  https://github.com/QINZHAOYU
+*   @brief     :  To benchmark scaling of DirectedGraphHandler on synthetic graphs.
+*
+*   usage: bench_GraphSearchingAlgo [kinds=random,grid,scalefree,road]
+*                                   [sizes=1000,10000,100000,1000000]
+*                                   [queryNum=1000] [threadNum=0]
+*
+*   Each graph kind and vertices number prints one line of JSON, e.g.
+*   {"graph":"grid","vertices":10000,"edges":39600,"load_ms":..,
+*    "single_p50_us":..,"single_p90_us":..,"single_p99_us":..,"single_max_us":..,
+*    "batch_ms":..,"batch_per_query_us":..,"found":..,"batch_found":..,"rss_mb":..,"peak_rss_mb":..}
+*
+** ******************************************************************************/
+
+#include "common/CommHeader.hpp"
+#include "modules/GraphSearchingAlgo.hpp"
+#include <random>
+#include <cmath>
+#include <sstream>
+#include <fstream>
+
+#ifdef WINDOWS
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#endif
+
+using namespace ccb;
+
+
+/// resident and peak resident memory of this process in MB.
+void memoryUsage(double &rss, double &peakRss)
+{
+	rss = peakRss = 0.0;
+#if defined(LINUX)
+	std::ifstream in("/proc/self/status");
+	string line;
+	while (std::getline(in, line))
+	{
+		if (line.compare(0, 6, "VmRSS:") == 0)
+		{
+			rss = std::atof(line.c_str() + 6) / 1024.0;
+		}
+		else if (line.compare(0, 6, "VmHWM:") == 0)
+		{
+			peakRss = std::atof(line.c_str() + 6) / 1024.0;
+		}
+	}
+#elif defined(WINDOWS)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		rss = counters.WorkingSetSize / 1048576.0;
+		peakRss = counters.PeakWorkingSetSize / 1048576.0;
+	}
+#endif
+}
+
+
+/// uniformly random edges, 4 out edges per vertice on average.
+vector<CsrEdge> randomGraph(int verNum, std::mt19937 &gen)
+{
+	vector<CsrEdge> edges(4 * static_cast<size_t>(verNum));
+	for (auto &edge : edges)
+	{
+		edge = {static_cast<int>(gen() % verNum), static_cast<int>(gen() % verNum),
+		        1.0 + gen() % 100
+		       };
+	}
+	return edges;
+}
+
+/// square grid with two-way edges between neighbours.
+vector<CsrEdge> gridGraph(int verNum, std::mt19937 &gen)
+{
+	int side = (std::max)(2, static_cast<int>(std::sqrt(static_cast<double>(verNum))));
+	vector<CsrEdge> edges;
+	edges.reserve(4 * static_cast<size_t>(side) * side);
+	for (int row = 0; row < side; ++row)
+	{
+		for (int col = 0; col < side; ++col)
+		{
+			int ver = row * side + col;
+			if (col + 1 < side)
+			{
+				double value = 1.0 + gen() % 100;
+				edges.push_back({ver, ver + 1, value});
+				edges.push_back({ver + 1, ver, value});
+			}
+			if (row + 1 < side)
+			{
+				double value = 1.0 + gen() % 100;
+				edges.push_back({ver, ver + side, value});
+				edges.push_back({ver + side, ver, value});
+			}
+		}
+	}
+	return edges;
+}
+
+/// Barabasi-Albert preferential attachment, 3 two-way edges per new vertice.
+vector<CsrEdge> scaleFreeGraph(int verNum, std::mt19937 &gen)
+{
+	const int degree = 3;
+	vector<CsrEdge> edges;
+	edges.reserve(2 * degree * static_cast<size_t>(verNum));
+	VecInt endpoints;  // each vertice once per incident edge.
+	endpoints.reserve(2 * degree * static_cast<size_t>(verNum));
+	for (int ver = 1; ver < verNum; ++ver)
+	{
+		for (int i = 0; i < degree; ++i)
+		{
+			int other = endpoints.empty() ? ver - 1 : endpoints[gen() % endpoints.size()];
+			double value = 1.0 + gen() % 100;
+			edges.push_back({ver, other, value});
+			edges.push_back({other, ver, value});
+			endpoints.emplace_back(ver);
+			endpoints.emplace_back(other);
+		}
+	}
+	return edges;
+}
+
+/// perturbed grid of euclidean edges with 20% removed, plus a few fast
+/// long-distance highways.
+vector<CsrEdge> roadGraph(int verNum, std::mt19937 &gen)
+{
+	int side = (std::max)(2, static_cast<int>(std::sqrt(static_cast<double>(verNum))));
+	std::uniform_real_distribution<double> jitter(-0.3, 0.3);
+	vector<array<double, 2>> points(static_cast<size_t>(side) * side);
+	for (int i = 0; i < side * side; ++i)
+	{
+		points[i] = {i % side + jitter(gen), i / side + jitter(gen)};
+	}
+	auto distance = [&points](int beg, int end)
+	{
+		return std::hypot(points[beg][0] - points[end][0], points[beg][1] - points[end][1]);
+	};
+
+	vector<CsrEdge> edges;
+	edges.reserve(4 * points.size());
+	auto addRoad = [&edges](int beg, int end, double value)
+	{
+		edges.push_back({beg, end, value});
+		edges.push_back({end, beg, value});
+	};
+	for (int row = 0; row < side; ++row)
+	{
+		for (int col = 0; col < side; ++col)
+		{
+			int ver = row * side + col;
+			if (col + 1 < side && gen() % 5 != 0)
+			{
+				addRoad(ver, ver + 1, distance(ver, ver + 1));
+			}
+			if (row + 1 < side && gen() % 5 != 0)
+			{
+				addRoad(ver, ver + side, distance(ver, ver + side));
+			}
+		}
+	}
+	for (int i = 0; i < side; ++i)
+	{
+		int beg = gen() % points.size(), end = gen() % points.size();
+		addRoad(beg, end, 0.3 * distance(beg, end));
+	}
+	return edges;
+}
+
+/// value at fraction of sorted samples.
+double percentile(const VecDbl &sorted, double fraction)
+{
+	if (sorted.empty())
+	{
+		return 0.0;
+	}
+	size_t ind = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+	return sorted[(std::min)(ind, sorted.size() - 1)];
+}
+
+void runBench(const string &kind, int verNum, int queryNum, int threadNum)
+{
+	std::mt19937 gen(2026);
+	vector<CsrEdge> edges = (kind == "grid") ? gridGraph(verNum, gen)
+	                        : (kind == "scalefree") ? scaleFreeGraph(verNum, gen)
+	                        : (kind == "road") ? roadGraph(verNum, gen)
+	                        : randomGraph(verNum, gen);
+
+	// vertices named by decimal index, loaded as users do.
+	DirectedGraphHandler::Graph graph;
+	graph.reserve(edges.size());
+	for (const auto &edge : edges)
+	{
+		graph.emplace_back(std::to_string(edge.beg), std::to_string(edge.end), edge.weight);
+	}
+	vector<CsrEdge>().swap(edges);
+
+	// names of vertices, as the handler indexes them in its own order.
+	VecStr ids;
+	ids.reserve(2 * graph.size());
+	for (const auto &edge : graph)
+	{
+		ids.emplace_back(std::get<0>(edge));
+		ids.emplace_back(std::get<1>(edge));
+	}
+	std::sort(ids.begin(), ids.end());
+	ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+	DirectedGraphHandler grapher;
+	auto start = steady_clock::now();
+	grapher.setGraph(graph);
+	double loadMs = duration<double, std::milli>(steady_clock::now() - start).count();
+	DirectedGraphHandler::Graph().swap(graph);
+
+	ShortestPathEngine engine = grapher.getQueryEngine();
+	int size = engine.graph().verticeNum();
+	vector<array<int, 2>> pairs(queryNum);
+	vector<array<string, 2>> names(queryNum);
+	for (int i = 0; i < queryNum; ++i)
+	{
+		// same pairs for single and batch queries.
+		names[i] = {ids[gen() % ids.size()], ids[gen() % ids.size()]};
+		pairs[i] = {grapher.getVerticeIndex(names[i][0]), grapher.getVerticeIndex(names[i][1])};
+	}
+	VecStr().swap(ids);
+
+	// latency of single pair queries by handler, each from its own source.
+	grapher.setPathTreeCapacity(1);
+	VecDbl latencies;
+	latencies.reserve(queryNum);
+	size_t found = 0;
+	for (const auto &pair : names)
+	{
+		auto begin = steady_clock::now();
+		found += grapher.runDijkstraAlgo(pair[0], pair[1]) ? 1 : 0;
+		latencies.emplace_back(duration<double, std::micro>(steady_clock::now() - begin).count());
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	// batch queries spread over threads.
+	PathStore pathes;
+	start = steady_clock::now();
+	engine.searchPathes(pairs, pathes, threadNum);
+	double batchMs = duration<double, std::milli>(steady_clock::now() - start).count();
+	size_t batchFound = 0;
+	for (size_t i = 0; i < pathes.size(); ++i)
+	{
+		batchFound += (pathes[i].size() > 0) ? 1 : 0;
+	}
+
+	double rss = 0.0, peakRss = 0.0;
+	memoryUsage(rss, peakRss);
+
+	std::ostringstream out;
+	out << "{\"graph\":\"" << kind << "\",\"vertices\":" << size
+	    << ",\"edges\":" << engine.graph().edgeNum()
+	    << ",\"load_ms\":" << loadMs
+	    << ",\"single_p50_us\":" << percentile(latencies, 0.50)
+	    << ",\"single_p90_us\":" << percentile(latencies, 0.90)
+	    << ",\"single_p99_us\":" << percentile(latencies, 0.99)
+	    << ",\"single_max_us\":" << (latencies.empty() ? 0.0 : latencies.back())
+	    << ",\"batch_ms\":" << batchMs
+	    << ",\"batch_per_query_us\":" << batchMs * 1000.0 / (std::max)(1, queryNum)
+	    << ",\"found\":" << found
+	    << ",\"batch_found\":" << batchFound
+	    << ",\"rss_mb\":" << rss << ",\"peak_rss_mb\":" << peakRss << "}";
+	cout << out.str() << endl;
+}
+
+/// to split comma separated list.
+VecStr splitList(const string &list)
+{
+	VecStr items;
+	std::istringstream in(list);
+	string item;
+	while (std::getline(in, item, ','))
+	{
+		if (!item.empty())
+		{
+			items.emplace_back(item);
+		}
+	}
+	return items;
+}
+
+
+int main(int argc, char *argv[])
+{
+	VecStr kinds = splitList((argc > 1) ? argv[1] : "random,grid,scalefree,road");
+	VecStr sizes = splitList((argc > 2) ? argv[2] : "1000,10000,100000,1000000");
+	int queryNum = (argc > 3) ? std::atoi(argv[3]) : 1000;
+	int threadNum = (argc > 4) ? std::atoi(argv[4]) : 0;
+
+	for (const auto &kind : kinds)
+	{
+		for (const auto &verNum : sizes)
+		{
+			runBench(kind, std::atoi(verNum.c_str()), queryNum, threadNum);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "CommHeader.hpp"
+#include <atomic>
+#include <thread>
+
+
+//===========================================================================
+// define commonly used helpers of threads.
+//===========================================================================
+/// number of threads to use, all cores if threadNum isn't positive.
+inline int threadsOf(int threadNum)
+{
+	return (threadNum > 0) ? threadNum
+	       : (std::max)(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+/// to run tasks [0, taskNum) over a pool of at most threadNum threads, the
+/// calling one included; each thread takes the next task until none is left.
+template<typename Index, typename Func>
+void parallelFor(Index taskNum, int threadNum, const Func &func)
+{
+	std::atomic<Index> next{0};
+	auto worker = [&]()
+	{
+		for (Index i = next++; i < taskNum; i = next++)
+		{
+			func(i);
+		}
+	};
+
+	vector<std::thread> threads;
+	for (Index i = 1; i < (std::min)(static_cast<Index>(threadNum), taskNum); ++i)
+	{
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+}
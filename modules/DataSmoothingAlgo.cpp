@@ -5,299 +5,1048 @@
 ** ******************************************************************************/
 
 #include "DataSmoothingAlgo.hpp"
-#include <numeric>
+#include "common/CommThreads.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SMOOTH_SIMD_X86
+#define SMOOTH_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define SMOOTH_SIMD_X86
+#define SMOOTH_TARGET(isa)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+// SIMD kernels must sum as scalar ones, so multiply and add are never fused.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
 
 
 namespace ccb
 {
 
-/////////////////////////////////////////////////////////////////////////////////
-// class DataSmoother.
-/////////////////////////////////////////////////////////////////////////////////
+namespace
+{
 
-void DataSmoother::linearSmoothN3(const vector<double> &orig, vector<double> &res)
+// weights of each method, rows of left boundary elements from the first one,
+// then row of interior elements; each row ends with divisor.
+constexpr double LINEAR_N3[2][4] =
 {
-	res.clear();
+	{5.0, 2.0, -1.0, 6.0},
+	{1.0, 1.0, 1.0, 3.0},
+};
 
-	// return origin data series.
-	size_t size = orig.size();
-	if (size < 3)
+constexpr double LINEAR_N5[3][6] =
+{
+	{3.0, 2.0, 1.0, 0.0, -1.0, 5.0},
+	{4.0, 3.0, 2.0, 1.0, 0.0, 10.0},
+	{1.0, 1.0, 1.0, 1.0, 1.0, 5.0},
+};
+
+constexpr double LINEAR_N7[4][8] =
+{
+	{13.0, 10.0, 7.0, 4.0, 1.0, -2.0, -5.0, 28.0},
+	{5.0, 4.0, 3.0, 2.0, 1.0, 0.0, -1.0, 14.0},
+	{7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 28.0},
+	{1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 7.0},
+};
+
+constexpr double QUADRATIC_N5[3][6] =
+{
+	{31.0, 9.0, -3.0, -5.0, 3.0, 35.0},
+	{9.0, 13.0, 12.0, 6.0, -5.0, 35.0},
+	{-3.0, 12.0, 17.0, 12.0, -3.0, 35.0},
+};
+
+constexpr double QUADRATIC_N7[4][8] =
+{
+	{32.0, 15.0, 3.0, -4.0, -6.0, -3.0, 5.0, 42.0},
+	{5.0, 4.0, 3.0, 2.0, 1.0, 0.0, -1.0, 14.0},
+	{1.0, 3.0, 4.0, 4.0, 3.0, 1.0, -2.0, 14.0},
+	{-2.0, 3.0, 6.0, 7.0, 6.0, 3.0, -2.0, 21.0},
+};
+
+constexpr double CUBIC_N5[3][6] =
+{
+	{69.0, 4.0, -6.0, 4.0, -1.0, 70.0},
+	{2.0, 27.0, 12.0, -8.0, 2.0, 35.0},
+	{-3.0, 12.0, 17.0, 12.0, -3.0, 35.0},
+};
+
+constexpr double CUBIC_N7[4][8] =
+{
+	{39.0, 8.0, -4.0, -4.0, 1.0, 4.0, -2.0, 42.0},
+	{8.0, 19.0, 16.0, 6.0, -4.0, -7.0, 4.0, 42.0},
+	{-4.0, 16.0, 19.0, 12.0, 2.0, -4.0, 1.0, 42.0},
+	{-2.0, 3.0, 6.0, 7.0, 6.0, 3.0, -2.0, 21.0},
+};
+
+template <int N>
+constexpr SmoothFilter toFilter(const double (&args)[N / 2 + 1][N + 1])
+{
+	return SmoothFilter{N, args[N / 2], args[0], args[0]};
+}
+
+// weights of copying elements.
+constexpr double IDENTITY[2] = {1.0, 1.0};
+
+const SmoothFilter FILTERS[] =
+{
+	toFilter<3>(LINEAR_N3),
+	toFilter<5>(LINEAR_N5),
+	toFilter<7>(LINEAR_N7),
+	toFilter<5>(QUADRATIC_N5),
+	toFilter<7>(QUADRATIC_N7),
+	toFilter<5>(CUBIC_N5),
+	toFilter<7>(CUBIC_N7),
+};
+
+
+/// weighted sum of window elements divided by the last weight, window elements
+/// are step apart, read backwards if step is negative.
+template <int N>
+inline double weightedSum(const double *elems, const double *args, int width,
+                          ptrdiff_t step)
+{
+	if (N > 0)
 	{
-		res = orig;
-		return;
+		width = N;  // unrolled by compiler.
 	}
 
-	// left boundary element.
-	double elem = (5.0 * orig[0] + 2.0 * orig[1] - orig[2]) / 6.0;
-	res.push_back(elem);
-
-	// linear smoothing by 3-points average.
-	for (int i = 1; i < size - 1; ++i)
+	double res = 0.0;
+	for (int i = 0; i < width; ++i)
 	{
-		elem = std::accumulate(orig.begin() + i - 1, orig.begin() + i + 1, 0.0) / 3.0;
-		res.push_back(elem);
+		res += args[i] * elems[step * i];
 	}
 
-	// right boundary element.
-	elem = (5.0 * orig[size - 1] + 2.0 * orig[size - 2] - orig[size - 3]) / 6.0;
-	res.push_back(elem);
+	return res / args[width];
 }
 
-void DataSmoother::linearSmoothN5(const vector<double> &orig, vector<double> &res)
+/// weighted sums of count windows starting at orig one after another, one by
+/// one; window elements are step apart.
+template <int N>
+void convolveScalar(const double *orig, size_t count, const double *args, int width,
+                    double *res, ptrdiff_t step)
 {
-	res.clear();
+	for (size_t i = 0; i < count; ++i)
+	{
+		res[i] = weightedSum<N>(orig + i, args, width, step);
+	}
+}
 
-	// return origin data series.
-	size_t size = orig.size();
-	if (size < 5)
+#if defined(SMOOTH_SIMD_X86)
+// SIMD kernels sum 4 vectors of outputs at a time, each output in the same
+// order as weightedSum(), then the rest one by one.
+SMOOTH_TARGET("sse2")
+void convolveSSE2(const double *orig, size_t count, const double *args, int width,
+                  double *res, ptrdiff_t step)
+{
+	const __m128d divisor = _mm_set1_pd(args[width]);
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
 	{
-		res = orig;
-		return;
+		__m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+		__m128d acc2 = _mm_setzero_pd(), acc3 = _mm_setzero_pd();
+		for (int k = 0; k < width; ++k)
+		{
+			const __m128d arg = _mm_set1_pd(args[k]);
+			const double *elems = orig + i + k * step;
+			acc0 = _mm_add_pd(acc0, _mm_mul_pd(arg, _mm_loadu_pd(elems)));
+			acc1 = _mm_add_pd(acc1, _mm_mul_pd(arg, _mm_loadu_pd(elems + 2)));
+			acc2 = _mm_add_pd(acc2, _mm_mul_pd(arg, _mm_loadu_pd(elems + 4)));
+			acc3 = _mm_add_pd(acc3, _mm_mul_pd(arg, _mm_loadu_pd(elems + 6)));
+		}
+		_mm_storeu_pd(res + i, _mm_div_pd(acc0, divisor));
+		_mm_storeu_pd(res + i + 2, _mm_div_pd(acc1, divisor));
+		_mm_storeu_pd(res + i + 4, _mm_div_pd(acc2, divisor));
+		_mm_storeu_pd(res + i + 6, _mm_div_pd(acc3, divisor));
 	}
+	convolveScalar<0>(orig + i, count - i, args, width, res + i, step);
+}
 
-	// smooth calculation.
-	VecDbl args0 = {3.0, 2.0, 1.0, 0.0, -1.0, 5.0};
-	VecDbl args1 = {4.0, 3.0, 2.0, 1.0, 0.0, 10.0};
-	VecDbl elems;
+SMOOTH_TARGET("avx2")
+void convolveAVX2(const double *orig, size_t count, const double *args, int width,
+                  double *res, ptrdiff_t step)
+{
+	const __m256d divisor = _mm256_set1_pd(args[width]);
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+		__m256d acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+		for (int k = 0; k < width; ++k)
+		{
+			const __m256d arg = _mm256_set1_pd(args[k]);
+			const double *elems = orig + i + k * step;
+			acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(arg, _mm256_loadu_pd(elems)));
+			acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(arg, _mm256_loadu_pd(elems + 4)));
+			acc2 = _mm256_add_pd(acc2, _mm256_mul_pd(arg, _mm256_loadu_pd(elems + 8)));
+			acc3 = _mm256_add_pd(acc3, _mm256_mul_pd(arg, _mm256_loadu_pd(elems + 12)));
+		}
+		_mm256_storeu_pd(res + i, _mm256_div_pd(acc0, divisor));
+		_mm256_storeu_pd(res + i + 4, _mm256_div_pd(acc1, divisor));
+		_mm256_storeu_pd(res + i + 8, _mm256_div_pd(acc2, divisor));
+		_mm256_storeu_pd(res + i + 12, _mm256_div_pd(acc3, divisor));
+	}
+	convolveScalar<0>(orig + i, count - i, args, width, res + i, step);
+}
 
-	// left boundary element.
-	elems.assign(orig.begin(), orig.begin() + 5);
-	res.push_back(smoother(elems, args0));
-	res.push_back(smoother(elems, args1));
+SMOOTH_TARGET("avx512f")
+void convolveAVX512(const double *orig, size_t count, const double *args, int width,
+                    double *res, ptrdiff_t step)
+{
+	const __m512d divisor = _mm512_set1_pd(args[width]);
+	size_t i = 0;
+	for (; i + 32 <= count; i += 32)
+	{
+		__m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+		__m512d acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+		for (int k = 0; k < width; ++k)
+		{
+			const __m512d arg = _mm512_set1_pd(args[k]);
+			const double *elems = orig + i + k * step;
+			acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(arg, _mm512_loadu_pd(elems)));
+			acc1 = _mm512_add_pd(acc1, _mm512_mul_pd(arg, _mm512_loadu_pd(elems + 8)));
+			acc2 = _mm512_add_pd(acc2, _mm512_mul_pd(arg, _mm512_loadu_pd(elems + 16)));
+			acc3 = _mm512_add_pd(acc3, _mm512_mul_pd(arg, _mm512_loadu_pd(elems + 24)));
+		}
+		_mm512_storeu_pd(res + i, _mm512_div_pd(acc0, divisor));
+		_mm512_storeu_pd(res + i + 8, _mm512_div_pd(acc1, divisor));
+		_mm512_storeu_pd(res + i + 16, _mm512_div_pd(acc2, divisor));
+		_mm512_storeu_pd(res + i + 24, _mm512_div_pd(acc3, divisor));
+	}
+	convolveScalar<0>(orig + i, count - i, args, width, res + i, step);
+}
+#endif
 
-	// linear smoothing by 5-points average.
-	for (int i = 2; i < size - 2; ++i)
+/// best instruction set of this cpu and os.
+SimdLevel supportedSimdLevel()
+{
+#if defined(SMOOTH_SIMD_X86) && defined(__GNUC__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+	{
+		return SimdLevel::AVX512;
+	}
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return SimdLevel::AVX2;
+	}
+	return __builtin_cpu_supports("sse2") ? SimdLevel::SSE2 : SimdLevel::Scalar;
+#elif defined(SMOOTH_SIMD_X86)
+	// cpu flags, and os saving of ymm and zmm registers.
+	int info[4];
+	__cpuid(info, 1);
+	bool hasOsSave = (info[2] & (1 << 27)) != 0;
+	bool hasAvx = hasOsSave && (info[2] & (1 << 28)) != 0;
+	unsigned long long xcr0 = hasOsSave ? _xgetbv(0) : 0;
+	__cpuidex(info, 7, 0);
+	if (hasAvx && (info[1] & (1 << 16)) && (xcr0 & 0xe6) == 0xe6)
 	{
-		elems.assign(orig.begin() + i - 2, orig.begin() + i + 3);
-		res.push_back(smoother(elems));
+		return SimdLevel::AVX512;
 	}
+	if (hasAvx && (info[1] & (1 << 5)) && (xcr0 & 0x6) == 0x6)
+	{
+		return SimdLevel::AVX2;
+	}
+	return SimdLevel::SSE2;  // always on x64.
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+const SimdLevel SUPPORTED_SIMD_LEVEL = supportedSimdLevel();
+std::atomic<SimdLevel> currSimdLevel{SUPPORTED_SIMD_LEVEL};
 
-	// right boundary element.
-	elems = reverseVec(VecDbl(orig.end() - 5, orig.end()));
-	res.push_back(smoother(elems, args1));
-	res.push_back(smoother(elems, args0));
+/// weighted sums of count windows starting at orig by instruction set in use.
+template <int N>
+void convolve(const double *orig, size_t count, const double *args, int width, double *res,
+              ptrdiff_t step = 1)
+{
+	switch (currSimdLevel.load(std::memory_order_relaxed))
+	{
+#if defined(SMOOTH_SIMD_X86)
+	case SimdLevel::AVX512:
+		convolveAVX512(orig, count, args, width, res, step);
+		break;
+	case SimdLevel::AVX2:
+		convolveAVX2(orig, count, args, width, res, step);
+		break;
+	case SimdLevel::SSE2:
+		convolveSSE2(orig, count, args, width, res, step);
+		break;
+#endif
+	default:
+		convolveScalar<N>(orig, count, args, width, res, step);
+		break;
+	}
 }
 
-void DataSmoother::linearSmoothN7(const vector<double> &orig, vector<double> &res)
+/// smoothing with window width N, or filter's width if N is 0.
+template <int N>
+void smoothWith(const SmoothFilter &filter, const double *orig, size_t size, double *res)
 {
-	res.clear();
+	const int width = (N > 0) ? N : filter.width;
+	const size_t half = width / 2;
 
 	// return origin data series.
-	size_t size = orig.size();
-	if (size < 7)
+	if (size < static_cast<size_t>(width))
 	{
-		res = orig;
+		std::copy(orig, orig + size, res);
 		return;
 	}
 
-	// smooth calculation.
-	VecDbl args0 = {13.0, 10.0, 7.0, 4.0, 1.0, -2.0, -5.0, 28.0};
-	VecDbl args1 = {5.0, 4.0, 3.0, 2.0, 1.0, 0.0, -1.0, 14.0};
-	VecDbl args2 = {7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 28.0};
-	VecDbl elems;
+	// boundary elements.
+	for (size_t j = 0; j < half; ++j)
+	{
+		res[j] = weightedSum<N>(orig, filter.left + j * (width + 1), width, 1);
+		res[size - 1 - j] = weightedSum<N>(orig + size - 1, filter.right + j * (width + 1),
+		                                   width, -1);
+	}
+
+	// interior elements.
+	convolve<N>(orig, size - 2 * half, filter.interior, width, res + half);
+}
+
+/// elements [inBeg, inEnd) of a series of size elements, no shorter than
+/// window, that smoothing its elements [beg, end) reads.
+void windowsRange(int width, size_t size, size_t beg, size_t end, size_t &inBeg,
+                  size_t &inEnd)
+{
+	const size_t half = width / 2;
+	inBeg = (beg < half) ? 0 : beg - half;
+	inEnd = (end + half > size) ? size : end + half;
+	if (beg < half)
+	{
+		inEnd = (std::max)(inEnd, static_cast<size_t>(width));  // first window.
+	}
+	if (end + half > size)
+	{
+		inBeg = (std::min)(inBeg, size - width);  // last window.
+	}
+}
 
-	// left boundary element.
-	elems.assign(orig.begin(), orig.begin() + 7);
-	res.push_back(smoother(elems, args0));
-	res.push_back(smoother(elems, args1));
-	res.push_back(smoother(elems, args2));
+/// to smooth elements [beg, end) of a series of size elements, no shorter than
+/// window, into res, given its elements from inBeg at in as windowsRange().
+void smoothRange(const SmoothFilter &filter, const double *in, size_t inBeg, size_t size,
+                 size_t beg, size_t end, double *res)
+{
+	const int width = filter.width;
+	const size_t half = width / 2, stride = width + 1;
+	size_t pos = beg;
+	for (; pos < (std::min)(end, half); ++pos)
+	{
+		res[pos - beg] = weightedSum<0>(in - inBeg, filter.left + pos * stride, width, 1);
+	}
 
-	// linear smoothing by 7-points average.
-	for (int i = 3; i < size - 3; ++i)
+	size_t interiorEnd = (std::min)(end, size - half);
+	if (pos < interiorEnd)
 	{
-		elems.assign(orig.begin() + i - 3, orig.begin() + i + 4);
-		res.push_back(smoother(elems));
+		convolve<0>(in + (pos - half - inBeg), interiorEnd - pos, filter.interior, width,
+		            res + (pos - beg));
+		pos = interiorEnd;
 	}
 
-	// right boundary element.
-	elems = reverseVec(VecDbl(orig.end() - 7, orig.end()));
-	res.push_back(smoother(elems, args2));
-	res.push_back(smoother(elems, args1));
-	res.push_back(smoother(elems, args0));
+	for (; pos < end; ++pos)
+	{
+		res[pos - beg] = weightedSum<0>(in + (size - 1 - inBeg),
+		                                filter.right + (size - 1 - pos) * stride, width, -1);
+	}
 }
 
-void DataSmoother::quadraticSmoothN5(const vector<double> &orig, vector<double> &res)
+/// Savitzky-Golay weights of derivative at element pos of window, for unit spacing.
+///
+/// Polynomial is fitted to positions scaled into [-2, 2] by QR decomposition
+/// of their powers(modified Gram-Schmidt, twice) in long double, so wide
+/// windows of high order keep their precision.
+void savitzkyGolayWeights(int width, int order, int deriv, int pos, double *weights)
 {
-	res.clear();
+	const int cols = order + 1;
+	const long double scale = (std::max)(1, width / 2);
+	vector<long double> q(static_cast<size_t>(cols) * width);
+	vector<long double> r(static_cast<size_t>(cols) * cols, 0.0L);
+	for (int i = 0; i < width; ++i)
+	{
+		long double t = (i - pos) / scale, power = 1.0L;
+		for (int j = 0; j < cols; ++j, power *= t)
+		{
+			q[j * width + i] = power;
+		}
+	}
 
-	// return origin data series.
-	size_t size = orig.size();
-	if (size < 5)
+	for (int j = 0; j < cols; ++j)
 	{
-		res = orig;
-		return;
+		long double *qj = &q[j * width];
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			for (int k = 0; k < j; ++k)
+			{
+				const long double *qk = &q[k * width];
+				long double dot = 0.0L;
+				for (int i = 0; i < width; ++i)
+				{
+					dot += qk[i] * qj[i];
+				}
+				for (int i = 0; i < width; ++i)
+				{
+					qj[i] -= dot * qk[i];
+				}
+				r[k * cols + j] += dot;
+			}
+		}
+
+		long double norm = 0.0L;
+		for (int i = 0; i < width; ++i)
+		{
+			norm += qj[i] * qj[i];
+		}
+		norm = std::sqrt(norm);
+		for (int i = 0; i < width; ++i)
+		{
+			qj[i] /= norm;
+		}
+		r[j * cols + j] = norm;
+	}
+
+	// row deriv of R^-1 * Q^T by forward substitution of R^T * v = e(deriv),
+	// then scaled by deriv! / scale^deriv.
+	vector<long double> v(cols, 0.0L);
+	for (int k = deriv; k < cols; ++k)
+	{
+		long double val = (k == deriv) ? 1.0L : 0.0L;
+		for (int l = deriv; l < k; ++l)
+		{
+			val -= r[l * cols + k] * v[l];
+		}
+		v[k] = val / r[k * cols + k];
+	}
+	long double factor = 1.0L;
+	for (int k = 1; k <= deriv; ++k)
+	{
+		factor *= k / scale;
+	}
+
+	for (int i = 0; i < width; ++i)
+	{
+		long double weight = 0.0L;
+		for (int k = deriv; k < cols; ++k)
+		{
+			weight += v[k] * q[k * width + i];
+		}
+		weights[i] = static_cast<double>(factor * weight);
+	}
+}
+
+/// Savitzky-Golay filter with its weights; rows of left boundary, interior,
+/// then right boundary if they differ in sign from left ones.
+struct SavitzkyGolayEntry
+{
+	VecDbl       weights;
+	SmoothFilter filter;
+};
+
+}  // end of anonymous namespace.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// struct SmoothFilter.
+/////////////////////////////////////////////////////////////////////////////////
+
+bool SmoothFilter::isValid() const
+{
+	return width >= 1 && width % 2 == 1 && interior && (width == 1 || (left && right));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// class DataSmoother.
+/////////////////////////////////////////////////////////////////////////////////
+
+void DataSmoother::linearSmoothN3(const VecDbl &orig, VecDbl &res)
+{
+	res.resize(orig.size());
+	linearSmoothN3(orig.data(), orig.size(), res.data());
+}
+
+void DataSmoother::linearSmoothN5(const VecDbl &orig, VecDbl &res)
+{
+	res.resize(orig.size());
+	linearSmoothN5(orig.data(), orig.size(), res.data());
+}
+
+void DataSmoother::linearSmoothN7(const VecDbl &orig, VecDbl &res)
+{
+	res.resize(orig.size());
+	linearSmoothN7(orig.data(), orig.size(), res.data());
+}
+
+void DataSmoother::quadraticSmoothN5(const VecDbl &orig, VecDbl &res)
+{
+	res.resize(orig.size());
+	quadraticSmoothN5(orig.data(), orig.size(), res.data());
+}
+
+void DataSmoother::quadraticSmoothN7(const VecDbl &orig, VecDbl &res)
+{
+	res.resize(orig.size());
+	quadraticSmoothN7(orig.data(), orig.size(), res.data());
+}
+
+void DataSmoother::cubicSmoothN5(const VecDbl &orig, VecDbl &res)
+{
+	res.resize(orig.size());
+	cubicSmoothN5(orig.data(), orig.size(), res.data());
+}
+
+void DataSmoother::cubicSmoothN7(const VecDbl &orig, VecDbl &res)
+{
+	res.resize(orig.size());
+	cubicSmoothN7(orig.data(), orig.size(), res.data());
+}
+
+void DataSmoother::linearSmoothN3(const double *orig, size_t size, double *res)
+{
+	smoothWith<3>(filter(SmoothMethod::LinearN3), orig, size, res);
+}
+
+void DataSmoother::linearSmoothN5(const double *orig, size_t size, double *res)
+{
+	smoothWith<5>(filter(SmoothMethod::LinearN5), orig, size, res);
+}
+
+void DataSmoother::linearSmoothN7(const double *orig, size_t size, double *res)
+{
+	smoothWith<7>(filter(SmoothMethod::LinearN7), orig, size, res);
+}
+
+void DataSmoother::quadraticSmoothN5(const double *orig, size_t size, double *res)
+{
+	smoothWith<5>(filter(SmoothMethod::QuadraticN5), orig, size, res);
+}
+
+void DataSmoother::quadraticSmoothN7(const double *orig, size_t size, double *res)
+{
+	smoothWith<7>(filter(SmoothMethod::QuadraticN7), orig, size, res);
+}
+
+void DataSmoother::cubicSmoothN5(const double *orig, size_t size, double *res)
+{
+	smoothWith<5>(filter(SmoothMethod::CubicN5), orig, size, res);
+}
+
+void DataSmoother::cubicSmoothN7(const double *orig, size_t size, double *res)
+{
+	smoothWith<7>(filter(SmoothMethod::CubicN7), orig, size, res);
+}
+
+const SmoothFilter &DataSmoother::filter(SmoothMethod method)
+{
+	return FILTERS[static_cast<int>(method)];
+}
+
+bool DataSmoother::smooth(const SmoothFilter &filter, const double *orig, size_t size,
+                          double *res)
+{
+	if (!filter.isValid())
+	{
+		std::cerr << "error: invalid smooth filter of width " << filter.width << _LOCA;
+		return false;
+	}
+
+	switch (filter.width)
+	{
+	case 3:
+		smoothWith<3>(filter, orig, size, res);
+		break;
+	case 5:
+		smoothWith<5>(filter, orig, size, res);
+		break;
+	case 7:
+		smoothWith<7>(filter, orig, size, res);
+		break;
+	default:
+		smoothWith<0>(filter, orig, size, res);
+		break;
 	}
 
-	// smooth calculation.
-	VecDbl args0 = {31.0, 9.0, -3.0, -5.0, 3.0, 35.0};
-	VecDbl args1 = {9.0, 13.0, 12.0, 6.0, -5.0, 35.0};
-	VecDbl args2 = {-3.0, 12.0, 17.0, 1.0, 1.0, 35.0};
-	VecDbl elems;
+	return true;
+}
 
-	// left boundary element.
-	elems.assign(orig.begin(), orig.begin() + 5);
-	res.push_back(smoother(elems, args0));
-	res.push_back(smoother(elems, args1));
+bool DataSmoother::smooth(const SmoothFilter &filter, const double *orig, size_t size,
+                          double *res, int threadNum)
+{
+	if (!filter.isValid())
+	{
+		std::cerr << "error: invalid smooth filter of width " << filter.width << _LOCA;
+		return false;
+	}
+	threadNum = threadsOf(threadNum);
 
-	// quadratic smoothing by 5-points average.
-	for (int i = 2; i < size - 2; ++i)
+	// a few chunks per thread for balance, each long enough to pay its start.
+	const size_t minChunk = 4096;
+	const size_t chunk = (std::max)(minChunk, size / (4 * static_cast<size_t>(threadNum)));
+	if (threadNum == 1 || size <= chunk || size < static_cast<size_t>(filter.width))
 	{
-		elems.assign(orig.begin() + i - 2, orig.begin() + i + 3);
-		res.push_back(smoother(elems, args2));
+		return smooth(filter, orig, size, res);
 	}
 
-	// right boundary element.
-	elems = reverseVec(VecDbl(orig.end() - 5, orig.end()));
-	res.push_back(smoother(elems, args1));
-	res.push_back(smoother(elems, args0));
+	// each chunk reads its halo of width/2 elements around in place, and only
+	// the first and last chunks have boundary elements.
+	parallelFor((size + chunk - 1) / chunk, threadNum, [&](size_t task)
+	{
+		size_t beg = task * chunk, end = (std::min)(size, beg + chunk);
+		size_t inBeg = 0, inEnd = 0;
+		windowsRange(filter.width, size, beg, end, inBeg, inEnd);
+		smoothRange(filter, orig + inBeg, inBeg, size, beg, end, res + beg);
+	});
+
+	return true;
+}
+
+void DataSmoother::smooth(SmoothMethod method, const VecDbl &orig, VecDbl &res)
+{
+	res.resize(orig.size());
+	smooth(filter(method), orig.data(), orig.size(), res.data());
+}
+
+bool DataSmoother::movingAverage(const VecDbl &orig, VecDbl &res, int width)
+{
+	res.resize(orig.size());
+	return movingAverage(orig.data(), orig.size(), res.data(), width);
 }
 
-void DataSmoother::quadraticSmoothN7(const vector<double> &orig, vector<double> &res)
+bool DataSmoother::movingAverage(const double *orig, size_t size, double *res, int width)
 {
-	res.clear();
+	if (width < 1 || width % 2 == 0)
+	{
+		std::cerr << "error: invalid moving average window " << width << _LOCA;
+		return false;
+	}
 
 	// return origin data series.
-	size_t size = orig.size();
-	if (size < 7)
+	const size_t half = width / 2;
+	if (size < static_cast<size_t>(width) || width == 1)
 	{
-		res = orig;
-		return;
+		std::copy(orig, orig + size, res);
+		return true;
 	}
 
-	// smooth calculation.
-	VecDbl args0 = {32.0, 15.0, 3.0, -4.0, -6.0, -3.0, 5.0, 42.0};
-	VecDbl args1 = {5.0, 4.0, 3.0, 2.0, 1.0, 0.0, -1.0, 14.0};
-	VecDbl args2 = {1.0, 3.0, 4.0, 4.0, 3.0, 1.0, -2.0, 14.0};
-	VecDbl args3 = {-2.0, 3.0, 6.0, 7.0, 6.0, 3.0, -2.0, 21.0};
-	VecDbl elems;
+	// boundary elements by least squares line of the first or last window,
+	// mean + slope * (pos - center), with slope from sum of (i - center) * elem.
+	const double center = static_cast<double>(half);
+	const double squares = width * (static_cast<double>(width) * width - 1.0) / 12.0;
+	auto fitLine = [&](const double *elems, ptrdiff_t step, double *vals, ptrdiff_t valStep)
+	{
+		double sum = 0.0, moment = 0.0;
+		for (int i = 0; i < width; ++i)
+		{
+			sum += elems[step * i];
+			moment += (i - center) * elems[step * i];
+		}
+		double mean = sum / width, slope = moment / squares;
+		for (size_t pos = 0; pos < half; ++pos)
+		{
+			vals[valStep * static_cast<ptrdiff_t>(pos)] = mean + slope * (pos - center);
+		}
+	};
+	fitLine(orig, 1, res, 1);
+	fitLine(orig + size - 1, -1, res + size - 1, -1);
 
-	// left boundary element.
-	elems.assign(orig.begin(), orig.begin() + 7);
-	res.push_back(smoother(elems, args0));
-	res.push_back(smoother(elems, args1));
-	res.push_back(smoother(elems, args2));
+	// interior elements by running sum of window, with lost low order bits
+	// kept apart(Neumaier), so error does not grow along series.
+	double sum = 0.0, lost = 0.0;
+	auto add = [&sum, &lost](double val)
+	{
+		double next = sum + val;
+		lost += (std::fabs(sum) >= std::fabs(val)) ? (sum - next) + val : (val - next) + sum;
+		sum = next;
+	};
+	for (int i = 0; i < width; ++i)
+	{
+		add(orig[i]);
+	}
+	res[half] = (sum + lost) / width;
+	for (size_t i = half + 1; i < size - half; ++i)
+	{
+		add(orig[i + half]);
+		add(-orig[i - half - 1]);
+		res[i] = (sum + lost) / width;
+	}
+
+	return true;
+}
+
+bool DataSmoother::smoothRepeatedly(const SmoothFilter &filter, int passNum,
+                                    const double *orig, size_t size, double *res)
+{
+	if (!filter.isValid() || passNum < 0)
+	{
+		std::cerr << "error: invalid smooth filter of width " << filter.width << " or "
+		          << passNum << " passes" << _LOCA;
+		return false;
+	}
 
-	// quadratic smoothing by 7-points average.
-	for (int i = 3; i < size - 3; ++i)
+	// return origin data series.
+	const size_t width = filter.width;
+	if (passNum == 0 || size < width)
 	{
-		elems.assign(orig.begin() + i - 3, orig.begin() + i + 4);
-		res.push_back(smoother(elems, args3));
+		std::copy(orig, orig + size, res);
+		return true;
 	}
 
-	// right boundary element.
-	elems = reverseVec(VecDbl(orig.end() - 7, orig.end()));
-	res.push_back(smoother(elems, args2));
-	res.push_back(smoother(elems, args1));
-	res.push_back(smoother(elems, args0));
+	// ranges of each pass needed by next one for a tile of result, the first
+	// one read from origin series; ranges grow by width/2 a pass at most,
+	// unless they reach the first or last window.
+	const size_t tileSize = 4096;
+	const size_t bufferSize = tileSize + passNum * (width + 1) + width;
+	VecDbl buffers[2] = {VecDbl(bufferSize), VecDbl(bufferSize)};
+	vector<array<size_t, 2>> ranges(passNum + 1);
+	for (size_t tileBeg = 0; tileBeg < size; tileBeg += tileSize)
+	{
+		ranges[passNum] = {tileBeg, (std::min)(size, tileBeg + tileSize)};
+		for (int p = passNum; p > 0; --p)
+		{
+			windowsRange(filter.width, size, ranges[p][0], ranges[p][1], ranges[p - 1][0],
+			             ranges[p - 1][1]);
+		}
+
+		const double *in = orig + ranges[0][0];
+		for (int p = 1; p <= passNum; ++p)
+		{
+			double *out = (p == passNum) ? res + tileBeg : buffers[p % 2].data();
+			smoothRange(filter, in, ranges[p - 1][0], size, ranges[p][0], ranges[p][1], out);
+			in = out;
+		}
+	}
+
+	return true;
 }
 
-void DataSmoother::cubicSmoothN5(const vector<double> &orig, vector<double> &res)
+bool DataSmoother::smoothRepeatedly(SmoothMethod method, int passNum, const VecDbl &orig,
+                                    VecDbl &res)
 {
-	res.clear();
+	res.resize(orig.size());
+	return smoothRepeatedly(filter(method), passNum, orig.data(), orig.size(), res.data());
+}
+
+bool DataSmoother::smoothChannels(const SmoothFilter &filter, const double *orig,
+                                  size_t length, size_t channelNum, ChannelLayout layout,
+                                  double *res, int threadNum)
+{
+	if (!filter.isValid())
+	{
+		std::cerr << "error: invalid smooth filter of width " << filter.width << _LOCA;
+		return false;
+	}
+	threadNum = threadsOf(threadNum);
+
+	// a few tasks per thread for balance.
+	auto blockOf = [threadNum](size_t num)
+	{
+		return (std::max)(size_t(1), num / (4 * static_cast<size_t>(threadNum)));
+	};
+
+	if (layout == ChannelLayout::Planar)
+	{
+		const size_t block = blockOf(channelNum);
+		parallelFor((channelNum + block - 1) / block, threadNum, [&](size_t task)
+		{
+			size_t end = (std::min)(channelNum, (task + 1) * block);
+			for (size_t c = task * block; c < end; ++c)
+			{
+				smooth(filter, orig + c * length, length, res + c * length);
+			}
+		});
+		return true;
+	}
 
 	// return origin data series.
-	size_t size = orig.size();
-	if (size < 5)
+	const int width = filter.width;
+	const size_t half = width / 2;
+	if (length < static_cast<size_t>(width))
 	{
-		res = orig;
-		return;
+		std::copy(orig, orig + length * channelNum, res);
+		return true;
+	}
+
+	// each row is convolved over channels, window elements a row apart.
+	const ptrdiff_t stride = static_cast<ptrdiff_t>(channelNum);
+	const double *lastRow = orig + (length - 1) * channelNum;
+	for (size_t j = 0; j < half; ++j)
+	{
+		convolve<0>(orig, channelNum, filter.left + j * (width + 1), width,
+		            res + j * channelNum, stride);
+		convolve<0>(lastRow, channelNum, filter.right + j * (width + 1), width,
+		            res + (length - 1 - j) * channelNum, -stride);
 	}
 
-	// smooth calculation.
-	VecDbl args0 = {69.0, 4.0, -6.0, 4.0, -1.0, 70.0};
-	VecDbl args1 = {2.0, 27.0, 12.0, -8.0, 2.0, 35.0};
-	VecDbl args2 = {-3.0, 12.0, 17.0, 12.0, -3.0, 35.0};
-	VecDbl elems;
+	// interior rows are contiguous, so are split into blocks of rows.
+	const size_t rows = length - 2 * half, block = blockOf(rows);
+	parallelFor((rows + block - 1) / block, threadNum, [&](size_t task)
+	{
+		size_t beg = task * block, end = (std::min)(rows, beg + block);
+		convolve<0>(orig + beg * channelNum, (end - beg) * channelNum, filter.interior, width,
+		            res + (half + beg) * channelNum, stride);
+	});
 
-	// left boundary element.
-	elems.assign(orig.begin(), orig.begin() + 5);
-	res.push_back(smoother(elems, args0));
-	res.push_back(smoother(elems, args1));
+	return true;
+}
 
-	// cubic smoothing by 5-points average.
-	for (int i = 2; i < size - 2; ++i)
+bool DataSmoother::savitzkyGolaySmooth(const VecDbl &orig, VecDbl &res, int width,
+                                       int order, int deriv, double spacing)
+{
+	res.resize(orig.size());
+	return savitzkyGolaySmooth(orig.data(), orig.size(), res.data(), width, order, deriv,
+	                           spacing);
+}
+
+bool DataSmoother::savitzkyGolaySmooth(const double *orig, size_t size, double *res,
+                                       int width, int order, int deriv, double spacing)
+{
+	const SmoothFilter *filter = savitzkyGolayFilter(width, order, deriv);
+	if (!filter)
 	{
-		elems.assign(orig.begin() + i - 2, orig.begin() + i + 3);
-		res.push_back(smoother(elems, args2));
+		return false;
+	}
+	if (deriv > 0 && (size < static_cast<size_t>(width) || !(spacing > 0.0)))
+	{
+		std::cerr << "error: derivative of " << size << " elements spaced by " << spacing
+		          << " by window " << width << _LOCA;
+		return false;
+	}
+
+	smooth(*filter, orig, size, res);
+	if (deriv > 0 && spacing != 1.0)
+	{
+		double factor = 1.0 / std::pow(spacing, deriv);
+		for (size_t i = 0; i < size; ++i)
+		{
+			res[i] *= factor;
+		}
 	}
 
-	// right boundary element.
-	elems = reverseVec(VecDbl(orig.end() - 5, orig.end()));
-	res.push_back(smoother(elems, args1));
-	res.push_back(smoother(elems, args0));
+	return true;
 }
 
-void DataSmoother::cubicSmoothN7(const vector<double> &orig, vector<double> &res)
+const SmoothFilter *DataSmoother::savitzkyGolayFilter(int width, int order, int deriv)
 {
-	res.clear();
+	if (width < 1 || width > SG_MAX_WIDTH || width % 2 == 0 || order < 0
+	        || order > SG_MAX_ORDER || order >= width || deriv < 0 || deriv > order)
+	{
+		std::cerr << "error: invalid Savitzky-Golay filter of width " << width << ", order "
+		          << order << " and derivative " << deriv << _LOCA;
+		return nullptr;
+	}
 
-	// return origin data series.
-	size_t size = orig.size();
-	if (size < 7)
+	// entries are never removed, so their filters stay valid.
+	static std::shared_mutex mutex;
+	static std::map<array<int, 3>, unique_ptr<SavitzkyGolayEntry>> table;
+	const array<int, 3> key{width, order, deriv};
 	{
-		res = orig;
-		return;
+		std::shared_lock<std::shared_mutex> lock(mutex);
+		auto iter = table.find(key);
+		if (iter != table.end())
+		{
+			return &iter->second->filter;
+		}
 	}
 
-	// smooth calculation.
-	VecDbl args0 = {39.0, 8.0, -4.0, -4.0, 1.0, 4.0, -2.0, 42.0};
-	VecDbl args1 = {8.0, 19.0, 16.0, 6.0, -4.0, -7.0, 4.0, 42.0};
-	VecDbl args2 = {-4.0, 16.0, 19.0, 12.0, 2.0, -4.0, 1.0, 42.0};
-	VecDbl args3 = {-2.0, 3.0, 6.0, 7.0, 6.0, 3.0, -2.0, 21.0};
-	VecDbl elems;
+	// weights on reversed window of right boundary change sign with odd derivative.
+	const int half = width / 2, stride = width + 1;
+	const bool hasRight = (deriv % 2 == 1);
+	auto entry = std::make_unique<SavitzkyGolayEntry>();
+	entry->weights.assign(static_cast<size_t>(stride) * (hasRight ? 2 * half + 1 : half + 1),
+	                      1.0);
+	double *rows = entry->weights.data();
+	for (int pos = 0; pos <= half; ++pos)
+	{
+		savitzkyGolayWeights(width, order, deriv, pos, rows + pos * stride);
+	}
+	if (hasRight)
+	{
+		for (int pos = 0; pos < half; ++pos)
+		{
+			for (int i = 0; i < width; ++i)
+			{
+				rows[(half + 1 + pos) * stride + i] = -rows[pos * stride + i];
+			}
+		}
+	}
+	const double *right = hasRight ? rows + (half + 1) * stride : rows;
+	entry->filter = {width, rows + half * stride, rows, right};
+
+	std::unique_lock<std::shared_mutex> lock(mutex);
+	auto &slot = table[key];
+	if (!slot)
+	{
+		slot = std::move(entry);
+	}
+	return &slot->filter;
+}
+
+SimdLevel DataSmoother::simdLevel()
+{
+	return currSimdLevel.load();
+}
+
+SimdLevel DataSmoother::setSimdLevel(SimdLevel level)
+{
+	level = (std::min)(level, SUPPORTED_SIMD_LEVEL);
+	currSimdLevel.store(level);
+	return level;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// class StreamSmoother.
+/////////////////////////////////////////////////////////////////////////////////
 
-	// left boundary element.
-	elems.assign(orig.begin(), orig.begin() + 7);
-	res.push_back(smoother(elems, args0));
-	res.push_back(smoother(elems, args1));
-	res.push_back(smoother(elems, args2));
+StreamSmoother::StreamSmoother(SmoothMethod method)
+	: StreamSmoother(DataSmoother::filter(method))
+{
+}
 
-	// cubic smoothing by 7-points average.
-	for (int i = 3; i < size - 3; ++i)
+StreamSmoother::StreamSmoother(const SmoothFilter &filter)
+	: _filter(filter)
+{
+	if (!_filter.isValid())
 	{
-		elems.assign(orig.begin() + i - 3, orig.begin() + i + 4);
-		res.push_back(smoother(elems, args3));
+		std::cerr << "error: invalid smooth filter of width " << _filter.width << _LOCA;
+		_filter = SmoothFilter{1, IDENTITY, IDENTITY, IDENTITY};
 	}
 
-	// right boundary element.
-	elems = reverseVec(VecDbl(orig.end() - 7, orig.end()));
-	res.push_back(smoother(elems, args2));
-	res.push_back(smoother(elems, args1));
-	res.push_back(smoother(elems, args0));
+	_tail.reserve(_filter.width);
+	_buffer.reserve(2 * static_cast<size_t>(_filter.width));
 }
 
-double DataSmoother::smoother(const VecDbl &elems, const VecDbl &args)
+size_t StreamSmoother::push(const double *elems, size_t size, double *res)
 {
-	if (args.size() != elems.size() + 1)
+	const size_t width = _filter.width, half = width / 2;
+	const size_t prevCount = _count;
+	_count += size;
+	if (_count < width)
 	{
-		std::cerr << "error: size of elems and args not match" << _LOCA;
-		return 0.0;
+		_tail.insert(_tail.end(), elems, elems + size);
+		return 0;
 	}
 
-	double res = 0.0;
-	for (int i = 0; i < elems.size(); ++i)
+	// elements [bufBeg, ...) of stream, holding windows across tail and chunk.
+	const size_t bufBeg = prevCount - _tail.size();
+	_buffer.assign(_tail.begin(), _tail.end());
+	_buffer.insert(_buffer.end(), elems, elems + (std::min)(size, width));
+
+	// smoothed elements [done, _count - half) of stream.
+	size_t done = (prevCount < width) ? 0 : prevCount - half;
+	size_t written = 0;
+	if (done == 0)
+	{
+		for (size_t j = 0; j < half; ++j)
+		{
+			res[written++] = weightedSum<0>(_buffer.data(), _filter.left + j * (width + 1),
+			                                static_cast<int>(width), 1);
+		}
+		done = half;
+	}
+
+	// windows starting in tail, then windows inside chunk.
+	size_t end = _count - half;
+	size_t bufEnd = (std::min)(prevCount + half, end);
+	if (done < bufEnd)
+	{
+		convolve<0>(_buffer.data() + (done - half - bufBeg), bufEnd - done, _filter.interior,
+		            static_cast<int>(width), res + written);
+		written += bufEnd - done;
+		done = bufEnd;
+	}
+	if (done < end)
+	{
+		convolve<0>(elems + (done - half - prevCount), end - done, _filter.interior,
+		            static_cast<int>(width), res + written);
+		written += end - done;
+	}
+
+	// keep last window.
+	if (size >= width)
+	{
+		_tail.assign(elems + size - width, elems + size);
+	}
+	else
 	{
-		res += args[i] * elems[i];
+		_tail.erase(_tail.begin(), _tail.begin() + (_tail.size() + size - width));
+		_tail.insert(_tail.end(), elems, elems + size);
 	}
 
-	return res / args.back();
+	return written;
 }
 
-double DataSmoother::smoother(const VecDbl &elems)
+size_t StreamSmoother::push(const VecDbl &elems, VecDbl &res)
 {
-	if (elems.empty())
+	size_t prevSize = res.size();
+	res.resize(prevSize + elems.size() + _filter.width / 2);
+	size_t written = push(elems.data(), elems.size(), res.data() + prevSize);
+	res.resize(prevSize + written);
+
+	return written;
+}
+
+size_t StreamSmoother::flush(double *res)
+{
+	const size_t width = _filter.width, half = width / 2;
+	size_t written = 0;
+	if (_count < width)
 	{
-		std::cerr << "error: smooth empty elements " << _LOCA;
-		return 0.0;
+		// short series is copied.
+		std::copy(_tail.begin(), _tail.end(), res);
+		written = _tail.size();
 	}
+	else
+	{
+		const double *last = _tail.data() + width - 1;
+		for (size_t j = half; j > 0; --j)
+		{
+			res[written++] = weightedSum<0>(last, _filter.right + (j - 1) * (width + 1),
+			                                static_cast<int>(width), -1);
+		}
+	}
+
+	reset();
+	return written;
+}
 
-	return std::accumulate(elems.begin(), elems.end(), 0.0) / elems.size();
+size_t StreamSmoother::flush(VecDbl &res)
+{
+	size_t prevSize = res.size();
+	res.resize(prevSize + _filter.width);
+	size_t written = flush(res.data() + prevSize);
+	res.resize(prevSize + written);
+
+	return written;
+}
+
+void StreamSmoother::reset()
+{
+	_count = 0;
+	_tail.clear();
+}
+
+size_t StreamSmoother::pending() const
+{
+	return (_count < static_cast<size_t>(_filter.width)) ? _count : _filter.width / 2;
 }
 
-VecDbl DataSmoother::reverseVec(VecDbl &&elems)
+const SmoothFilter &StreamSmoother::filter() const
 {
-	std::reverse(elems.begin(), elems.end());
-	return elems;
+	return _filter;
 }
 
-}  // end of namespace ccb.
\ No newline at end of file
+}  // end of namespace ccb.
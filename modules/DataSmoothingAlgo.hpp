@@ -21,7 +21,63 @@
 namespace ccb
 {
 
+/// \brief Weights of a smoothing filter over an odd window of elements.
+///
+/// \details Each row holds `width` weights followed by their divisor. Interior
+///        elements are smoothed by `interior` row over the window centered on
+///        them, the first width/2 elements by `left` rows over the first window,
+///        and the last width/2 elements by `right` rows over the reversed last
+///        window, the last element by row 0.
+struct SmoothFilter
+{
+	int           width{0};         ///< odd window width.
+	const double *interior{nullptr}; ///< weights of interior elements.
+	const double *left{nullptr};     ///< width/2 rows of left boundary elements.
+	const double *right{nullptr};    ///< width/2 rows of right boundary elements.
+
+	/// if width is odd and all rows are given.
+	bool isValid() const;
+};
+
+/// \brief Smoothing methods with fixed windows.
+enum class SmoothMethod
+{
+	LinearN3,
+	LinearN5,
+	LinearN7,
+	QuadraticN5,
+	QuadraticN7,
+	CubicN5,
+	CubicN7
+};
+
+/// \brief Layouts of series of channels with the same length.
+enum class ChannelLayout
+{
+	Planar,      ///< series of each channel one after another(structure of arrays).
+	Interleaved  ///< elements of all channels at each step one after another(row-major).
+};
+
+const int SG_MAX_WIDTH = 101;  ///< max window width of Savitzky-Golay filter.
+const int SG_MAX_ORDER = 6;    ///< max polynomial order of Savitzky-Golay filter.
+
+/// \brief Instruction sets of smoothing convolution.
+enum class SimdLevel
+{
+	Scalar,
+	SSE2,
+	AVX2,
+	AVX512
+};
+
+
 /// \brief To smooth data series.
+///
+/// \details All methods share one convolution kernel over windows read in
+///        place, vectorized by the best instruction set found at runtime.
+///        Series shorter than window are copied as they are.
+///
+/// \attention Result must not overlap origin series.
 class DataSmoother
 {
 public:
@@ -35,10 +91,114 @@ public:
 	static void cubicSmoothN5(const VecDbl &orig, VecDbl &res);
 	static void cubicSmoothN7(const VecDbl &orig, VecDbl &res);
 
+	/// pointer versions never allocate, while vector ones only resize result.
+	static void linearSmoothN3(const double *orig, size_t size, double *res);
+	static void linearSmoothN5(const double *orig, size_t size, double *res);
+	static void linearSmoothN7(const double *orig, size_t size, double *res);
+
+	static void quadraticSmoothN5(const double *orig, size_t size, double *res);
+	static void quadraticSmoothN7(const double *orig, size_t size, double *res);
+
+	static void cubicSmoothN5(const double *orig, size_t size, double *res);
+	static void cubicSmoothN7(const double *orig, size_t size, double *res);
+
+	/// weights of a fixed window smoothing method.
+	static const SmoothFilter &filter(SmoothMethod method);
+
+	/// to smooth `size` elements of orig into preallocated res by filter.
+	static bool smooth(const SmoothFilter &filter, const double *orig, size_t size,
+	                   double *res);
+	static void smooth(SmoothMethod method, const VecDbl &orig, VecDbl &res);
+
+	/// to smooth as above by chunks over threadNum threads, or all cores if 0;
+	/// each chunk reads width/2 elements around it, so result is the same.
+	static bool smooth(const SmoothFilter &filter, const double *orig, size_t size,
+	                   double *res, int threadNum);
+
+	/// to smooth series by average of odd window of any width, each element in
+	/// O(1) time by a compensated running sum; boundary elements by least
+	/// squares line of the first or last window, as linear smoothing does.
+	static bool movingAverage(const VecDbl &orig, VecDbl &res, int width);
+	static bool movingAverage(const double *orig, size_t size, double *res, int width);
+
+	/// to smooth series passNum times by filter, the same as calling smooth()
+	/// repeatedly, in one sweep of tiles small enough to stay in cache.
+	static bool smoothRepeatedly(const SmoothFilter &filter, int passNum, const double *orig,
+	                             size_t size, double *res);
+	static bool smoothRepeatedly(SmoothMethod method, int passNum, const VecDbl &orig,
+	                             VecDbl &res);
+
+	/// to smooth channelNum series of length elements each in layout into res
+	/// of the same layout, by threadNum threads or all cores if 0; interleaved
+	/// channels are vectorized across channels, planar ones by channel.
+	static bool smoothChannels(const SmoothFilter &filter, const double *orig, size_t length,
+	                           size_t channelNum, ChannelLayout layout, double *res,
+	                           int threadNum = 0);
+
+	/// to smooth series, or estimate its derivative of elements' spacing, by
+	/// Savitzky-Golay filter; series shorter than window is copied if smoothed.
+	static bool savitzkyGolaySmooth(const VecDbl &orig, VecDbl &res, int width, int order,
+	                                int deriv = 0, double spacing = 1.0);
+	static bool savitzkyGolaySmooth(const double *orig, size_t size, double *res, int width,
+	                                int order, int deriv = 0, double spacing = 1.0);
+
+	/// Savitzky-Golay weights of unit spacing, nullptr if arguments are invalid;
+	/// weights are computed once and cached for all threads.
+	static const SmoothFilter *savitzkyGolayFilter(int width, int order, int deriv = 0);
+
+	/// instruction set in use, the best supported one by default.
+	static SimdLevel simdLevel();
+
+	/// to use an instruction set, limited to supported ones; returns the one in use.
+	/// Results are bit-identical on any instruction set.
+	static SimdLevel setSimdLevel(SimdLevel level);
+};
+
+
+/// \brief To smooth an unbounded series given in chunks, as DataSmoother does
+///        the whole series.
+///
+/// \details Only the last window of elements is kept. Each element is smoothed
+///        once width/2 elements after it have arrived, the first width/2 ones
+///        together when the first window is full, and the last width/2 ones by
+///        right boundary weights when the stream is flushed. Windows inside a
+///        chunk are read in place by the convolution kernel of DataSmoother,
+///        so results are bit-identical to smoothing the whole series.
+///
+/// \attention Weights of filter must outlive this object; an invalid filter
+///        is replaced by copying elements.
+class StreamSmoother
+{
+public:
+	explicit StreamSmoother(SmoothMethod method);
+	explicit StreamSmoother(const SmoothFilter &filter);
+
+	/// to take elements and write the ones smoothed by now into res, which has
+	/// room for `size` + width/2 elements; returns number written.
+	size_t push(const double *elems, size_t size, double *res);
+
+	/// to take elements and append the ones smoothed by now to res.
+	size_t push(const VecDbl &elems, VecDbl &res);
+
+	/// to end stream and write the rest elements into res, which has room for
+	/// window width elements; returns number written. Stream restarts after.
+	size_t flush(double *res);
+	size_t flush(VecDbl &res);
+
+	/// to drop all elements taken and restart stream.
+	void reset();
+
+	/// number of elements taken but not smoothed yet, at most width/2 once the
+	/// first window is full.
+	size_t pending() const;
+
+	const SmoothFilter &filter() const;
+
 private:
-	static double smoother(const VecDbl &elems, const VecDbl &args);
-	static double smoother(const VecDbl &elems);
-	static VecDbl reverseVec(VecDbl &&elems);
+	SmoothFilter _filter;        // weights of smoothing.
+	size_t       _count{0};      // number of elements taken.
+	VecDbl       _tail;          // last window of elements taken.
+	VecDbl       _buffer;        // tail joined with head of chunk.
 };
 
 }  // end of namespace ccb.
\ No newline at end of file
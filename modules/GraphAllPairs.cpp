@@ -0,0 +1,284 @@
+/** *****************************************************************************
+*    @File      :  GraphAllPairs.cpp
+*    @Brief     :  To compute all pairs shortest path lengths of directed graph.
+*
+** ******************************************************************************/
+
+#include "common/CommConsts.hpp"
+#include "common/CommThreads.hpp"
+#include "GraphAllPairs.hpp"
+#include <limits>
+
+#if defined(__AVX512F__) || defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+
+namespace ccb
+{
+
+namespace
+{
+
+const double INF_DIST = std::numeric_limits<double>::infinity();
+
+// SIMD vector of doubles as compiled for.
+#if defined(__AVX512F__)
+using SimdVec = __m512d;
+const int SIMD_WIDTH = 8;
+inline SimdVec simdLoad(const double *ptr)
+{
+	return _mm512_loadu_pd(ptr);
+}
+inline void simdStore(double *ptr, SimdVec val)
+{
+	_mm512_storeu_pd(ptr, val);
+}
+inline SimdVec simdSet(double val)
+{
+	return _mm512_set1_pd(val);
+}
+inline SimdVec simdMinPlus(SimdVec acc, SimdVec val, SimdVec top)
+{
+	return _mm512_min_pd(acc, _mm512_add_pd(val, top));
+}
+#elif defined(__AVX__)
+using SimdVec = __m256d;
+const int SIMD_WIDTH = 4;
+inline SimdVec simdLoad(const double *ptr)
+{
+	return _mm256_loadu_pd(ptr);
+}
+inline void simdStore(double *ptr, SimdVec val)
+{
+	_mm256_storeu_pd(ptr, val);
+}
+inline SimdVec simdSet(double val)
+{
+	return _mm256_set1_pd(val);
+}
+inline SimdVec simdMinPlus(SimdVec acc, SimdVec val, SimdVec top)
+{
+	return _mm256_min_pd(acc, _mm256_add_pd(val, top));
+}
+#elif defined(__SSE2__) || defined(_M_X64)
+using SimdVec = __m128d;
+const int SIMD_WIDTH = 2;
+inline SimdVec simdLoad(const double *ptr)
+{
+	return _mm_loadu_pd(ptr);
+}
+inline void simdStore(double *ptr, SimdVec val)
+{
+	_mm_storeu_pd(ptr, val);
+}
+inline SimdVec simdSet(double val)
+{
+	return _mm_set1_pd(val);
+}
+inline SimdVec simdMinPlus(SimdVec acc, SimdVec val, SimdVec top)
+{
+	return _mm_min_pd(acc, _mm_add_pd(val, top));
+}
+#else
+using SimdVec = double;
+const int SIMD_WIDTH = 1;
+inline SimdVec simdLoad(const double *ptr)
+{
+	return *ptr;
+}
+inline void simdStore(double *ptr, SimdVec val)
+{
+	*ptr = val;
+}
+inline SimdVec simdSet(double val)
+{
+	return val;
+}
+inline SimdVec simdMinPlus(SimdVec acc, SimdVec val, SimdVec top)
+{
+	return (val + top < acc) ? val + top : acc;
+}
+#endif
+
+const int SIMD_REGS  = 8;   // vectors of a row kept in registers.
+const int SIMD_CHUNK = SIMD_REGS * SIMD_WIDTH;
+
+/// row[j] = min(row[j], val + top[j]) for j in [0, cols).
+inline void minPlusRow(double *row, const double *top, double val, int cols)
+{
+	int j = 0;
+	SimdVec vals = simdSet(val);
+	for (; j + SIMD_WIDTH <= cols; j += SIMD_WIDTH)
+	{
+		simdStore(row + j, simdMinPlus(simdLoad(row + j), vals, simdLoad(top + j)));
+	}
+	for (; j < cols; ++j)
+	{
+		double sum = val + top[j];
+		row[j] = (sum < row[j]) ? sum : row[j];
+	}
+}
+
+/// row[j] = min(row[j], left[k] + top[k][j]) over all k, for a chunk of row
+/// kept in registers.
+inline void minPlusChunk(double *row, const double *left, const double *top,
+                         size_t stride, int depth)
+{
+	SimdVec acc[SIMD_REGS];
+	for (int n = 0; n < SIMD_REGS; ++n)
+	{
+		acc[n] = simdLoad(row + n * SIMD_WIDTH);
+	}
+	for (int k = 0; k < depth; ++k)
+	{
+		if (left[k] != INF_DIST)
+		{
+			SimdVec vals = simdSet(left[k]);
+			const double *topRow = top + k * stride;
+#if defined(__GNUC__)
+#pragma GCC unroll 8
+#endif
+			for (int n = 0; n < SIMD_REGS; ++n)
+			{
+				acc[n] = simdMinPlus(acc[n], vals, simdLoad(topRow + n * SIMD_WIDTH));
+			}
+		}
+	}
+	for (int n = 0; n < SIMD_REGS; ++n)
+	{
+		simdStore(row + n * SIMD_WIDTH, acc[n]);
+	}
+}
+
+}  // end of anonymous namespace.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// class AllPairsShortestPath.
+/////////////////////////////////////////////////////////////////////////////////
+
+bool AllPairsShortestPath::FloydWarshallAlgo(const CsrGraph &graph, VecDbl &dist,
+        int threadNum)
+{
+	// row-major distance matrix of edges.
+	int size = graph.verticeNum();
+	size_t stride = static_cast<size_t>(size);
+	dist.assign(stride * stride, INF_DIST);
+	for (int i = 0; i < size; ++i)
+	{
+		dist[i * stride + i] = 0.0;
+		for (int e = graph.edgeBegin(i); e < graph.edgeEnd(i); ++e)
+		{
+			double &elem = dist[i * stride + graph.target(e)];
+			elem = (std::min)(elem, graph.weight(e));
+		}
+	}
+
+	threadNum = threadsOf(threadNum);
+	int blockNum = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	auto lengthOf = [size](int block)
+	{
+		return (std::min)(BLOCK_SIZE, size - block * BLOCK_SIZE);
+	};
+	auto tileOf = [&dist, stride](int rowBlock, int colBlock)
+	{
+		return dist.data() + rowBlock * BLOCK_SIZE * stride + colBlock * BLOCK_SIZE;
+	};
+
+	for (int kb = 0; kb < blockNum; ++kb)
+	{
+		int depth = lengthOf(kb);
+		double *diag = tileOf(kb, kb);
+		relaxTile(diag, diag, diag, stride, depth, depth, depth);
+
+		// tiles in row and column of diagonal tile depend on it only.
+		parallelFor(2 * blockNum, threadNum, [&](int task)
+		{
+			int other = task / 2;
+			if (other == kb)
+			{
+				return;
+			}
+			if (task % 2 == 0)
+			{
+				double *tile = tileOf(kb, other);
+				relaxTile(tile, diag, tile, stride, depth, lengthOf(other), depth);
+			}
+			else
+			{
+				double *tile = tileOf(other, kb);
+				relaxTile(tile, tile, diag, stride, lengthOf(other), depth, depth);
+			}
+		});
+
+		// remaining tiles are independent; a task relaxes a whole row of tiles.
+		parallelFor(blockNum, threadNum, [&](int ib)
+		{
+			if (ib == kb)
+			{
+				return;
+			}
+			for (int jb = 0; jb < blockNum; ++jb)
+			{
+				if (jb != kb)
+				{
+					relaxTile(tileOf(ib, jb), tileOf(ib, kb), tileOf(kb, jb), stride,
+					          lengthOf(ib), lengthOf(jb), depth);
+				}
+			}
+		});
+	}
+
+	bool hasNegativeCycle = false;
+	for (int i = 0; i < size; ++i)
+	{
+		hasNegativeCycle = hasNegativeCycle || dist[i * stride + i] < 0.0;
+	}
+	std::replace(dist.begin(), dist.end(), INF_DIST, _DBL_MAX);
+	return !hasNegativeCycle;
+}
+
+void AllPairsShortestPath::relaxTile(double *tile, const double *left, const double *top,
+                                     size_t stride, int rows, int cols, int depth)
+{
+	// tile[i][j] = min(tile[i][j], left[i][k] + top[k][j]), k in ascending order.
+	if (tile != left && tile != top)
+	{
+		// independent tile: chunks of each row stay in registers over all k.
+		for (int i = 0; i < rows; ++i)
+		{
+			double *row = tile + i * stride;
+			const double *leftRow = left + i * stride;
+			int j = 0;
+			for (; j + SIMD_CHUNK <= cols; j += SIMD_CHUNK)
+			{
+				minPlusChunk(row + j, leftRow, top + j, stride, depth);
+			}
+			for (int k = 0; k < depth && j < cols; ++k)
+			{
+				if (leftRow[k] != INF_DIST)
+				{
+					minPlusRow(row + j, top + k * stride + j, leftRow[k], cols - j);
+				}
+			}
+		}
+		return;
+	}
+
+	// k is outermost, which stays valid when tile is left or top itself.
+	for (int k = 0; k < depth; ++k)
+	{
+		const double *topRow = top + k * stride;
+		for (int i = 0; i < rows; ++i)
+		{
+			double val = left[i * stride + k];
+			if (val != INF_DIST)
+			{
+				minPlusRow(tile + i * stride, topRow, val, cols);
+			}
+		}
+	}
+}
+
+}  // end of namespace ccb.
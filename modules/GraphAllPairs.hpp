@@ -0,0 +1,48 @@
+/** *****************************************************************************
+*   @copyright :  Copyright (C) 2026 Qin ZhaoYu. All rights reserved.
+*
+*   @author    :  Qin ZhaoYu.
+*   @see       :  https://github.com/QINZHAOYU
+*   @brief     :  To compute all pairs shortest path lengths of directed graph.
+*
+*   Change History:
+*   -----------------------------------------------------------------------------
+*   v1.0, 2026/10/17, Qin ZhaoYu, zhaoyu.qin@foxmail.com
+*   Init model.
+*
+** ******************************************************************************/
+
+#pragma once
+#include "common/CommHeader.hpp"
+#include "common/CommStructs.hpp"
+#include "GraphSearchingAlgo.hpp"
+
+
+/// \brief namespace of cpp code box.
+namespace ccb
+{
+
+/// \brief All pairs shortest path lengths by blocked Floyd-Warshall algorithm.
+///
+/// \details Distance matrix is split into square tiles; for each diagonal tile
+///        the tile itself, then tiles of its row and column, then all others
+///        are relaxed, so that tiles of a phase are independent and spread over
+///        threads, and each relaxation works on tiles staying in cache. The
+///        min-plus inner loop uses AVX-512, AVX or SSE2 as compiled for.
+///
+///        Complexity is O(V^3) time and O(V^2) memory, for dense analysis of
+///        graphs with up to about 10^4 vertices.
+class AllPairsShortestPath
+{
+public:
+	static const int BLOCK_SIZE = 64;  ///< rows and columns of a tile.
+
+	/// returns `false` on negative cycle, without printing.
+	static bool FloydWarshallAlgo(const CsrGraph &graph, VecDbl &dist, int threadNum = 0);
+
+private:
+	static void relaxTile(double *tile, const double *left, const double *top,
+	                      size_t stride, int rows, int cols, int depth);
+};
+
+}  // end of namespace ccb.
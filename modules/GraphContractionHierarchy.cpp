@@ -0,0 +1,686 @@
+/** *****************************************************************************
+*    @File      :  GraphContractionHierarchy.cpp
+*    @Brief     :  To preprocess directed graph into contraction hierarchies.
+*
+** ******************************************************************************/
+
+#include "common/CommConsts.hpp"
+#include "GraphContractionHierarchy.hpp"
+#include <fstream>
+#include <queue>
+#include <cstring>
+
+
+namespace ccb
+{
+
+namespace
+{
+
+const char     CH_MAGIC[8]      = {'C', 'C', 'B', 'C', 'H', 'I', 'E', 'R'};
+const uint32_t CH_VERSION       = 2;
+const int      WITNESS_SETTLED  = 500;  // max settled vertices of witness search.
+
+/// arc of graph under contraction.
+struct Arc
+{
+	int    target;
+	int    middle;
+	double weight;
+};
+
+/// to add arc or shorten existing arc with same target.
+void addArc(vector<Arc> &arcs, const Arc &arc)
+{
+	for (auto &elem : arcs)
+	{
+		if (elem.target == arc.target)
+		{
+			if (arc.weight < elem.weight)
+			{
+				elem = arc;
+			}
+			return;
+		}
+	}
+	arcs.emplace_back(arc);
+}
+
+// little-endian byte writers and readers.
+void writeUI32(std::ostream &out, uint32_t val)
+{
+	char bytes[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		bytes[i] = static_cast<char>((val >> (8 * i)) & 0xFF);
+	}
+	out.write(bytes, 4);
+}
+
+void writeUI64(std::ostream &out, uint64_t val)
+{
+	char bytes[8];
+	for (int i = 0; i < 8; ++i)
+	{
+		bytes[i] = static_cast<char>((val >> (8 * i)) & 0xFF);
+	}
+	out.write(bytes, 8);
+}
+
+void writeF64(std::ostream &out, double val)
+{
+	uint64_t bits;
+	std::memcpy(&bits, &val, sizeof(bits));
+	writeUI64(out, bits);
+}
+
+uint32_t readUI32(std::istream &in)
+{
+	unsigned char bytes[4] = {0};
+	in.read(reinterpret_cast<char *>(bytes), 4);
+
+	uint32_t val = 0;
+	for (int i = 0; i < 4; ++i)
+	{
+		val |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+	}
+	return val;
+}
+
+uint64_t readUI64(std::istream &in)
+{
+	unsigned char bytes[8] = {0};
+	in.read(reinterpret_cast<char *>(bytes), 8);
+
+	uint64_t val = 0;
+	for (int i = 0; i < 8; ++i)
+	{
+		val |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+	}
+	return val;
+}
+
+double readF64(std::istream &in)
+{
+	uint64_t bits = readUI64(in);
+	double val;
+	std::memcpy(&val, &bits, sizeof(val));
+	return val;
+}
+
+void writeInts(std::ostream &out, const VecInt &vals)
+{
+	writeUI32(out, static_cast<uint32_t>(vals.size()));
+	for (int val : vals)
+	{
+		writeUI32(out, static_cast<uint32_t>(val));
+	}
+}
+
+void writeDbls(std::ostream &out, const VecDbl &vals)
+{
+	writeUI32(out, static_cast<uint32_t>(vals.size()));
+	for (double val : vals)
+	{
+		writeF64(out, val);
+	}
+}
+
+/// to count bytes left in stream, so that a broken size never allocates.
+size_t remainingBytes(std::istream &in)
+{
+	std::streampos pos = in.tellg();
+	in.seekg(0, std::ios::end);
+	std::streampos end = in.tellg();
+	in.seekg(pos);
+	return (pos < 0 || end < pos) ? 0 : static_cast<size_t>(end - pos);
+}
+
+bool readInts(std::istream &in, VecInt &vals)
+{
+	size_t size = readUI32(in);
+	if (!in.good() || size > remainingBytes(in) / 4)
+	{
+		return false;
+	}
+	vals.resize(size);
+	for (auto &val : vals)
+	{
+		val = static_cast<int>(readUI32(in));
+	}
+	return in.good();
+}
+
+bool readDbls(std::istream &in, VecDbl &vals)
+{
+	size_t size = readUI32(in);
+	if (!in.good() || size > remainingBytes(in) / 8)
+	{
+		return false;
+	}
+	vals.resize(size);
+	for (auto &val : vals)
+	{
+		val = readF64(in);
+	}
+	return in.good();
+}
+
+/// to mix a word into checksum, as words of graph snapshot.
+uint64_t mixWord(uint64_t hash, uint64_t word)
+{
+	return (((hash << 5) | (hash >> 59)) ^ word) * 0x9E3779B97F4A7C15ULL;
+}
+
+uint64_t mixInts(uint64_t hash, const VecInt &vals)
+{
+	hash = mixWord(hash, vals.size());
+	for (int val : vals)
+	{
+		hash = mixWord(hash, static_cast<uint32_t>(val));
+	}
+	return hash;
+}
+
+uint64_t mixDbls(uint64_t hash, const VecDbl &vals)
+{
+	hash = mixWord(hash, vals.size());
+	for (double val : vals)
+	{
+		uint64_t bits;
+		std::memcpy(&bits, &val, sizeof(bits));
+		hash = mixWord(hash, bits);
+	}
+	return hash;
+}
+
+/// if arcs are in range: offsets ascend from 0 to arcs number, targets are
+/// vertices and middles are vertices or -1.
+bool isValidArcs(const VecInt &offsets, const VecInt &targets, const VecInt &middles,
+                 int verNum)
+{
+	if (offsets.empty() || offsets.front() != 0
+	        || offsets.back() != static_cast<int>(targets.size()))
+	{
+		return false;
+	}
+	for (size_t i = 1; i < offsets.size(); ++i)
+	{
+		if (offsets[i] < offsets[i - 1])
+		{
+			return false;
+		}
+	}
+	for (size_t e = 0; e < targets.size(); ++e)
+	{
+		if (targets[e] < 0 || targets[e] >= verNum || middles[e] < -1 || middles[e] >= verNum)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+}  // end of anonymous namespace.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// class ContractionHierarchy.
+/////////////////////////////////////////////////////////////////////////////////
+
+bool ContractionHierarchy::build(const CsrGraph &graph)
+{
+	int size = graph.verticeNum();
+	if (size == 0)
+	{
+		std::cerr << "empty graph" << _LOCA;
+		return false;
+	}
+
+	// load graph under contraction, self loops never make shortest path.
+	vector<vector<Arc>> outArcs(size), inArcs(size);
+	for (int i = 0; i < size; ++i)
+	{
+		for (int e = graph.edgeBegin(i); e < graph.edgeEnd(i); ++e)
+		{
+			if (graph.weight(e) < 0.0)
+			{
+				std::cerr << "invalid graph: has negative edge value" << _LOCA;
+				return false;
+			}
+			if (graph.target(e) != i)
+			{
+				addArc(outArcs[i], {graph.target(e), -1, graph.weight(e)});
+				addArc(inArcs[graph.target(e)], {i, -1, graph.weight(e)});
+			}
+		}
+	}
+
+	VecBool contracted(size, false);
+	VecInt deletedNeighbors(size, 0);
+
+	// local Dijkstra algorithm among remaining vertices, skipping one vertice.
+	VecDbl witnessDist(size, _DBL_MAX);
+	VecInt witnessTouched;
+	using Entry = std::pair<double, int>;
+	auto witnessSearch = [&](int source, int skipVer, double maxDist)
+	{
+		std::priority_queue<Entry, vector<Entry>, std::greater<Entry>> heap;
+		witnessDist[source] = 0.0;
+		witnessTouched.emplace_back(source);
+		heap.emplace(0.0, source);
+
+		int settled = 0;
+		while (!heap.empty() && settled < WITNESS_SETTLED)
+		{
+			Entry top = heap.top();
+			heap.pop();
+			if (top.first > witnessDist[top.second])
+			{
+				continue;  // outdated entry.
+			}
+			if (top.first > maxDist)
+			{
+				break;
+			}
+
+			settled++;
+			for (const auto &arc : outArcs[top.second])
+			{
+				if (contracted[arc.target] || arc.target == skipVer)
+				{
+					continue;
+				}
+
+				double dist = top.first + arc.weight;
+				if (dist < witnessDist[arc.target])
+				{
+					if (witnessDist[arc.target] >= _DBL_MAX)
+					{
+						witnessTouched.emplace_back(arc.target);
+					}
+					witnessDist[arc.target] = dist;
+					heap.emplace(dist, arc.target);
+				}
+			}
+		}
+	};
+
+	// count or add shortcuts needed to contract a vertice.
+	auto contract = [&](int ver, bool isApplied)
+	{
+		int count = 0;
+		for (const auto &inArc : inArcs[ver])
+		{
+			if (contracted[inArc.target])
+			{
+				continue;
+			}
+
+			double maxDist = 0.0;
+			for (const auto &outArc : outArcs[ver])
+			{
+				if (!contracted[outArc.target] && outArc.target != inArc.target)
+				{
+					maxDist = (std::max)(maxDist, inArc.weight + outArc.weight);
+				}
+			}
+			witnessSearch(inArc.target, ver, maxDist);
+
+			for (const auto &outArc : outArcs[ver])
+			{
+				double dist = inArc.weight + outArc.weight;
+				if (contracted[outArc.target] || outArc.target == inArc.target
+				        || witnessDist[outArc.target] <= dist)
+				{
+					continue;  // witness path found.
+				}
+
+				count++;
+				if (isApplied)
+				{
+					addArc(outArcs[inArc.target], {outArc.target, ver, dist});
+					addArc(inArcs[outArc.target], {inArc.target, ver, dist});
+				}
+			}
+
+			for (int touched : witnessTouched)
+			{
+				witnessDist[touched] = _DBL_MAX;
+			}
+			witnessTouched.clear();
+		}
+
+		return count;
+	};
+
+	// priority by edge difference and number of contracted neighbors.
+	auto priority = [&](int ver)
+	{
+		int degree = 0;
+		for (const auto &arc : inArcs[ver])
+		{
+			degree += contracted[arc.target] ? 0 : 1;
+		}
+		for (const auto &arc : outArcs[ver])
+		{
+			degree += contracted[arc.target] ? 0 : 1;
+		}
+
+		return contract(ver, false) - degree + deletedNeighbors[ver];
+	};
+
+	using Order = std::pair<int, int>;
+	std::priority_queue<Order, vector<Order>, std::greater<Order>> queue;
+	for (int i = 0; i < size; ++i)
+	{
+		queue.emplace(priority(i), i);
+	}
+
+	// contract vertices lazily: priority is updated before contraction.
+	_rank.assign(size, 0);
+	int order = 0;
+	while (!queue.empty())
+	{
+		int ver = queue.top().second;
+		queue.pop();
+
+		int currPriority = priority(ver);
+		if (!queue.empty() && currPriority > queue.top().first)
+		{
+			queue.emplace(currPriority, ver);
+			continue;
+		}
+
+		contract(ver, true);
+		contracted[ver] = true;
+		_rank[ver] = order++;
+
+		for (const auto &arc : inArcs[ver])
+		{
+			deletedNeighbors[arc.target]++;
+		}
+		for (const auto &arc : outArcs[ver])
+		{
+			deletedNeighbors[arc.target]++;
+		}
+	}
+
+	// split edges and shortcuts into upward and downward graph.
+	vector<vector<Arc>> upArcs(size), downArcs(size);
+	for (int i = 0; i < size; ++i)
+	{
+		for (const auto &arc : outArcs[i])
+		{
+			(_rank[i] < _rank[arc.target])
+			? upArcs[i].push_back(arc)
+			: downArcs[arc.target].push_back({i, arc.middle, arc.weight});
+		}
+	}
+
+	auto toUpwardGraph = [size](vector<vector<Arc>> &arcs, UpwardGraph & upward)
+	{
+		upward = UpwardGraph();
+		upward.offsets.assign(size + 1, 0);
+		for (int i = 0; i < size; ++i)
+		{
+			std::sort(arcs[i].begin(), arcs[i].end(), [](const Arc & lhs, const Arc & rhs)
+			{
+				return lhs.target < rhs.target;
+			});
+			for (const auto &arc : arcs[i])
+			{
+				upward.targets.emplace_back(arc.target);
+				upward.middles.emplace_back(arc.middle);
+				upward.weights.emplace_back(arc.weight);
+			}
+			upward.offsets[i + 1] = static_cast<int>(upward.targets.size());
+		}
+	};
+	toUpwardGraph(upArcs, _upGraph);
+	toUpwardGraph(downArcs, _downGraph);
+
+	_graphChecksum = checksum(graph);
+	return true;
+}
+
+bool ContractionHierarchy::save(const string &file) const
+{
+	std::ofstream out(file, std::ios::out | std::ios::binary);
+	if (!out.is_open())
+	{
+		std::cerr << "failed to open file: " << file << _LOCA;
+		return false;
+	}
+
+	// content checksum closes the file.
+	out.write(CH_MAGIC, sizeof(CH_MAGIC));
+	writeUI32(out, CH_VERSION);
+	writeUI64(out, _graphChecksum);
+	writeInts(out, _rank);
+	uint64_t hash = mixInts(mixWord(0, _graphChecksum), _rank);
+	for (const UpwardGraph *graph : {&_upGraph, &_downGraph})
+	{
+		writeInts(out, graph->offsets);
+		writeInts(out, graph->targets);
+		writeInts(out, graph->middles);
+		writeDbls(out, graph->weights);
+		hash = mixDbls(mixInts(mixInts(mixInts(hash, graph->offsets), graph->targets),
+		                       graph->middles), graph->weights);
+	}
+	writeUI64(out, hash);
+
+	return out.good();
+}
+
+bool ContractionHierarchy::load(const string &file)
+{
+	std::ifstream in(file, std::ios::in | std::ios::binary);
+	if (!in.is_open())
+	{
+		std::cerr << "failed to open file: " << file << _LOCA;
+		return false;
+	}
+
+	char magic[sizeof(CH_MAGIC)] = {0};
+	in.read(magic, sizeof(magic));
+	if (std::memcmp(magic, CH_MAGIC, sizeof(CH_MAGIC)) != 0 || readUI32(in) != CH_VERSION)
+	{
+		std::cerr << "invalid contraction hierarchy file: " << file << _LOCA;
+		return false;
+	}
+
+	// sizes and indices are checked as well as checksum, since queries index
+	// arrays without checks.
+	_graphChecksum = readUI64(in);
+	bool status = readInts(in, _rank);
+	int size = static_cast<int>(_rank.size());
+	uint64_t hash = mixInts(mixWord(0, _graphChecksum), _rank);
+	for (UpwardGraph *graph : {&_upGraph, &_downGraph})
+	{
+		status = status && readInts(in, graph->offsets) && readInts(in, graph->targets)
+		         && readInts(in, graph->middles) && readDbls(in, graph->weights);
+		status = status && graph->offsets.size() == _rank.size() + 1
+		         && graph->targets.size() == graph->weights.size()
+		         && graph->middles.size() == graph->weights.size()
+		         && isValidArcs(graph->offsets, graph->targets, graph->middles, size);
+		hash = mixDbls(mixInts(mixInts(mixInts(hash, graph->offsets), graph->targets),
+		                       graph->middles), graph->weights);
+	}
+	for (int i = 0; status && i < size; ++i)
+	{
+		status = _rank[i] >= 0 && _rank[i] < size;
+	}
+	status = status && readUI64(in) == hash && in.good();
+
+	if (!status)
+	{
+		std::cerr << "broken contraction hierarchy file: " << file << _LOCA;
+		_rank.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool ContractionHierarchy::isMatched(const CsrGraph &graph) const
+{
+	return verticeNum() == graph.verticeNum() && _graphChecksum == checksum(graph);
+}
+
+uint64_t ContractionHierarchy::checksum(const CsrGraph &graph)
+{
+	// FNV-1a hash of vertices number, edges and their values.
+	uint64_t hash = 14695981039346656037ULL;
+	auto mix = [&hash](uint64_t val)
+	{
+		for (int i = 0; i < 8; ++i)
+		{
+			hash ^= (val >> (8 * i)) & 0xFF;
+			hash *= 1099511628211ULL;
+		}
+	};
+
+	mix(static_cast<uint64_t>(graph.verticeNum()));
+	for (int i = 0; i < graph.verticeNum(); ++i)
+	{
+		mix(static_cast<uint64_t>(graph.edgeEnd(i) - graph.edgeBegin(i)));
+		for (int e = graph.edgeBegin(i); e < graph.edgeEnd(i); ++e)
+		{
+			uint64_t bits;
+			double weight = graph.weight(e);
+			std::memcpy(&bits, &weight, sizeof(bits));
+			mix(static_cast<uint64_t>(graph.target(e)));
+			mix(bits);
+		}
+	}
+
+	return hash;
+}
+
+bool ContractionHierarchy::searchPath(int begVerticeInd, int endVerticeInd,
+                                      DijkstraWorkspace &workspace,
+                                      DijkstraWorkspace &backWorkspace, VecInt &route) const
+{
+	route.clear();
+
+	int size = verticeNum();
+	workspace.prepare(size, begVerticeInd);
+	backWorkspace.prepare(size, endVerticeInd);
+	workspace.stats.queryNum++;
+
+	double minDist = (begVerticeInd == endVerticeInd) ? 0.0 : _DBL_MAX;
+	int meetVerInd = (begVerticeInd == endVerticeInd) ? begVerticeInd : -1;
+
+	// search upward from both sides alternately, each until its frontier
+	// exceeds the shortest path length found.
+	workspace.heap.push(begVerticeInd, 0.0);
+	backWorkspace.heap.push(endVerticeInd, 0.0);
+	while (true)
+	{
+		bool isForward = !workspace.heap.empty() && workspace.heap.topKey() < minDist;
+		bool isBackward = !backWorkspace.heap.empty() && backWorkspace.heap.topKey() < minDist;
+		if (!isForward && !isBackward)
+		{
+			break;
+		}
+
+		if (isForward)
+		{
+			searchUpward(_upGraph, workspace, backWorkspace, minDist, meetVerInd);
+		}
+		if (isBackward)
+		{
+			searchUpward(_downGraph, backWorkspace, workspace, minDist, meetVerInd);
+		}
+	}
+
+	if (meetVerInd < 0)
+	{
+		return false;
+	}
+
+	// collect hierarchy path through meeting vertice.
+	VecInt upRoute = ShortestPathEngine::parsePath(workspace.path, begVerticeInd, meetVerInd);
+	for (int ver = meetVerInd; ver != endVerticeInd; )
+	{
+		ver = backWorkspace.path[ver];
+		upRoute.emplace_back(ver);
+	}
+
+	// unpack shortcuts into original edges.
+	route.emplace_back(begVerticeInd);
+	for (size_t i = 1; i < upRoute.size(); ++i)
+	{
+		unpackArc(upRoute[i - 1], upRoute[i], route);
+	}
+
+	return true;
+}
+
+void ContractionHierarchy::searchUpward(const UpwardGraph &graph, DijkstraWorkspace &curr,
+                                        const DijkstraWorkspace &other, double &minDist,
+                                        int &meetVerInd) const
+{
+	int postVerInd = curr.heap.pop();
+	curr.book[postVerInd] = true;
+	curr.stats.settledVertices++;
+
+	for (int e = graph.offsets[postVerInd]; e < graph.offsets[postVerInd + 1]; ++e)
+	{
+		int j = graph.targets[e];
+		double currDist = curr.dist[postVerInd] + graph.weights[e];
+		if (!curr.book[j] && curr.dist[j] > currDist)
+		{
+			curr.touch(j, currDist, postVerInd);
+			curr.heap.push(j, currDist);
+			curr.stats.relaxedEdges++;
+		}
+
+		if (other.dist[j] < _DBL_MAX && currDist + other.dist[j] < minDist)
+		{
+			minDist = currDist + other.dist[j];
+			meetVerInd = j;
+		}
+	}
+}
+
+int ContractionHierarchy::findMiddle(int begVerticeInd, int endVerticeInd) const
+{
+	// upward arc is stored at lower end, downward arc at lower end reversely.
+	bool isUpward = _rank[begVerticeInd] < _rank[endVerticeInd];
+	const UpwardGraph &graph = isUpward ? _upGraph : _downGraph;
+	int from = isUpward ? begVerticeInd : endVerticeInd;
+	int to = isUpward ? endVerticeInd : begVerticeInd;
+
+	auto first = graph.targets.begin() + graph.offsets[from];
+	auto last = graph.targets.begin() + graph.offsets[from + 1];
+	auto iter = std::lower_bound(first, last, to);
+
+	return (iter != last && *iter == to) ? graph.middles[iter - graph.targets.begin()] : -1;
+}
+
+void ContractionHierarchy::unpackArc(int begVerticeInd, int endVerticeInd,
+                                     VecInt &route) const
+{
+	// replace shortcut with its two arcs until original edge reached.
+	vector<std::pair<int, int>> arcs{{begVerticeInd, endVerticeInd}};
+	while (!arcs.empty())
+	{
+		auto arc = arcs.back();
+		arcs.pop_back();
+
+		int middle = findMiddle(arc.first, arc.second);
+		if (middle < 0)
+		{
+			route.emplace_back(arc.second);
+		}
+		else
+		{
+			arcs.emplace_back(middle, arc.second);
+			arcs.emplace_back(arc.first, middle);
+		}
+	}
+}
+
+}  // end of namespace ccb.
@@ -0,0 +1,75 @@
+/** *****************************************************************************
+*   @copyright :  Copyright (C) 2026 Qin ZhaoYu. All rights reserved.
+*
+*   @author    :  Qin ZhaoYu.
+*   @see       :  https://github.com/QINZHAOYU
+*   @brief     :  To preprocess directed graph into contraction hierarchies.
+*
+*   Change History:
+*   -----------------------------------------------------------------------------
+*   v1.0, 2026/10/17, Qin ZhaoYu, zhaoyu.qin@foxmail.com
+*   Init model.
+*
+** ******************************************************************************/
+
+#pragma once
+#include "common/CommHeader.hpp"
+#include "common/CommStructs.hpp"
+#include "GraphSearchingAlgo.hpp"
+
+
+/// \brief namespace of cpp code box.
+namespace ccb
+{
+
+/// \brief Contraction hierarchies(CH) of a static directed graph.
+///
+/// \details Vertices are contracted one by one in order of edge difference,
+///        adding shortcuts to keep shortest path lengths among the remaining
+///        vertices. A query then runs bidirectional Dijkstra algorithm only
+///        upward in the hierarchy, which settles a few hundred vertices even
+///        on large road networks, and unpacks shortcuts into original edges.
+///
+/// \attention Hierarchy is bound to the graph it built from; any change of the
+///        graph requires rebuilding. Negative edge value is not supported.
+class ContractionHierarchy
+{
+public:
+	bool build(const CsrGraph &graph);
+	bool save(const string &file) const;
+	bool load(const string &file);
+
+	bool isMatched(const CsrGraph &graph) const;
+	int verticeNum() const
+	{
+		return static_cast<int>(_rank.size());
+	}
+
+	bool searchPath(int begVerticeInd, int endVerticeInd, DijkstraWorkspace &workspace,
+	                DijkstraWorkspace &backWorkspace, VecInt &route) const;
+
+	static uint64_t checksum(const CsrGraph &graph);
+
+private:
+	/// arcs of upward graph stored in CSR format, sorted by target.
+	struct UpwardGraph
+	{
+		VecInt offsets;  ///< offsets of each vertice's arcs.
+		VecInt targets;  ///< higher ranked end of each arc.
+		VecInt middles;  ///< contracted middle vertice of shortcut, -1 for edge.
+		VecDbl weights;  ///< length of each arc.
+	};
+
+	void searchUpward(const UpwardGraph &graph, DijkstraWorkspace &curr,
+	                  const DijkstraWorkspace &other, double &minDist, int &meetVerInd) const;
+	int findMiddle(int begVerticeInd, int endVerticeInd) const;
+	void unpackArc(int begVerticeInd, int endVerticeInd, VecInt &route) const;
+
+private:
+	VecInt             _rank;               // contraction order of each vertice.
+	UpwardGraph        _upGraph;            // arcs to higher ranked vertices.
+	UpwardGraph        _downGraph;          // reversed arcs from higher ranked vertices.
+	uint64_t           _graphChecksum{0};   // checksum of graph built from.
+};
+
+}  // end of namespace ccb.
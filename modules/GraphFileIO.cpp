@@ -0,0 +1,1003 @@
+/** *****************************************************************************
+*    @File      :  GraphFileIO.cpp
+*    @Brief     :  To load directed graph from large files via memory mapping.
+*
+** ******************************************************************************/
+
+#include "common/CommConsts.hpp"
+#include "common/CommThreads.hpp"
+#include "GraphFileIO.hpp"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <charconv>
+#include <string_view>
+#include <atomic>
+
+#ifndef WINDOWS
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+namespace ccb
+{
+
+namespace
+{
+
+const char     EDGES_MAGIC[8]   = {'C', 'C', 'B', 'E', 'D', 'G', 'E', 'S'};
+const uint32_t EDGES_VERSION    = 1;
+const size_t   EDGES_HEADER     = 24;   // magic, version, reserved and edges number.
+const size_t   EDGES_RECORD     = 16;   // begin, end and value of an edge.
+const size_t   MIN_CHUNK_SIZE   = 1 << 16;  // min bytes of a text chunk.
+
+const char     SNAP_MAGIC[8]    = {'C', 'C', 'B', 'G', 'R', 'A', 'P', 'H'};
+const uint32_t SNAP_VERSION     = 1;
+const uint32_t SNAP_BYTE_ORDER  = 0x01020304;  // native byte order tag.
+const size_t   SNAP_HEADER      = 48;   // bytes of file header.
+const size_t   SNAP_SECTION     = 16;   // bytes of section header.
+
+/// tags of snapshot sections.
+enum SnapTag : uint32_t
+{
+	TAG_NAME_OFFSETS = 1,   ///< uint64 offsets of vertices names, V + 1.
+	TAG_NAME_CHARS,         ///< chars of all vertices names.
+	TAG_OFFSETS,            ///< int32 CSR offsets, V + 1.
+	TAG_TARGETS,            ///< int32 CSR targets, E.
+	TAG_WEIGHTS,            ///< float64 CSR weights, E.
+	TAG_REV_OFFSETS,        ///< CSR offsets of reverse graph.
+	TAG_REV_TARGETS,        ///< CSR targets of reverse graph.
+	TAG_REV_WEIGHTS,        ///< CSR weights of reverse graph.
+	TAG_NUM
+};
+
+/// open addressing table interning names as views into mapped file; hash and
+/// first 8 bytes are kept in slot, so that probing rarely touches the file.
+class NameTable
+{
+public:
+	NameTable()
+		: _slots(1024)
+	{
+	}
+
+	int size() const
+	{
+		return _size;
+	}
+
+	/// to find index of name, or insert it with index `ind`.
+	int intern(std::string_view name, int ind)
+	{
+		if (2 * (_size + 1) > static_cast<int>(_slots.size()))
+		{
+			grow();
+		}
+
+		size_t hash = std::hash<std::string_view>()(name);
+		uint64_t prefix = prefixOf(name);
+		size_t mask = _slots.size() - 1;
+		for (size_t pos = hash & mask; ; pos = (pos + 1) & mask)
+		{
+			Slot &slot = _slots[pos];
+			if (slot.ind < 0)
+			{
+				slot = {hash, prefix, name, ind};
+				_size++;
+				return ind;
+			}
+			if (isMatched(slot, hash, prefix, name))
+			{
+				return slot.ind;
+			}
+		}
+	}
+
+	/// index of existing name.
+	int find(std::string_view name) const
+	{
+		size_t hash = std::hash<std::string_view>()(name);
+		uint64_t prefix = prefixOf(name);
+		size_t mask = _slots.size() - 1;
+		for (size_t pos = hash & mask; ; pos = (pos + 1) & mask)
+		{
+			const Slot &slot = _slots[pos];
+			if (slot.ind < 0 || isMatched(slot, hash, prefix, name))
+			{
+				return slot.ind;
+			}
+		}
+	}
+
+private:
+	struct Slot
+	{
+		size_t           hash{0};
+		uint64_t         prefix{0};
+		std::string_view name;
+		int              ind{-1};
+	};
+
+	static uint64_t prefixOf(std::string_view name)
+	{
+		uint64_t prefix = 0;
+		std::memcpy(&prefix, name.data(), (std::min)(name.size(), sizeof(prefix)));
+		return prefix;
+	}
+
+	static bool isMatched(const Slot &slot, size_t hash, uint64_t prefix, std::string_view name)
+	{
+		if (slot.hash != hash || slot.prefix != prefix || slot.name.size() != name.size())
+		{
+			return false;
+		}
+		return name.size() <= sizeof(prefix)
+		       || std::memcmp(slot.name.data() + sizeof(prefix), name.data() + sizeof(prefix),
+		                      name.size() - sizeof(prefix)) == 0;
+	}
+
+	void grow()
+	{
+		vector<Slot> slots(2 * _slots.size());
+		size_t mask = slots.size() - 1;
+		for (const auto &slot : _slots)
+		{
+			if (slot.ind >= 0)
+			{
+				size_t pos = slot.hash & mask;
+				while (slots[pos].ind >= 0)
+				{
+					pos = (pos + 1) & mask;
+				}
+				slots[pos] = slot;
+			}
+		}
+		_slots.swap(slots);
+	}
+
+	vector<Slot>       _slots;              // power of two slots.
+	int                _size{0};            // number of names.
+};
+
+uint32_t decodeUI32(const char *bytes)
+{
+	uint32_t val = 0;
+	for (int i = 0; i < 4; ++i)
+	{
+		val |= static_cast<uint32_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+	}
+	return val;
+}
+
+uint64_t decodeUI64(const char *bytes)
+{
+	return decodeUI32(bytes) | (static_cast<uint64_t>(decodeUI32(bytes + 4)) << 32);
+}
+
+void encodeUI32(char *bytes, uint32_t val)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		bytes[i] = static_cast<char>((val >> (8 * i)) & 0xFF);
+	}
+}
+
+void encodeUI64(char *bytes, uint64_t val)
+{
+	encodeUI32(bytes, static_cast<uint32_t>(val));
+	encodeUI32(bytes + 4, static_cast<uint32_t>(val >> 32));
+}
+
+size_t padOf(size_t size)
+{
+	return (8 - size % 8) % 8;
+}
+
+/// to mix 8-byte words into checksum; size is multiple of 8.
+uint64_t mixWords(uint64_t hash, const char *data, size_t size)
+{
+	for (size_t i = 0; i < size; i += 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, data + i, sizeof(word));
+		hash = (((hash << 5) | (hash >> 59)) ^ word) * 0x9E3779B97F4A7C15ULL;
+	}
+	return hash;
+}
+
+/// stream writer computing checksum of written bytes.
+class SnapshotWriter
+{
+public:
+	explicit SnapshotWriter(std::ostream &out)
+		: _out(out)
+	{
+	}
+
+	void write(const void *data, size_t size)
+	{
+		_out.write(static_cast<const char *>(data), size);
+
+		// hash whole words, keeping the tail for next writing.
+		const char *bytes = static_cast<const char *>(data);
+		if (_carrySize > 0)
+		{
+			size_t num = (std::min)(size, 8 - _carrySize);
+			std::memcpy(_carry + _carrySize, bytes, num);
+			_carrySize += num;
+			bytes += num;
+			size -= num;
+			if (_carrySize < 8)
+			{
+				return;
+			}
+			_hash = mixWords(_hash, _carry, 8);
+			_carrySize = 0;
+		}
+
+		size_t words = size - size % 8;
+		_hash = mixWords(_hash, bytes, words);
+		std::memcpy(_carry, bytes + words, size - words);
+		_carrySize = size - words;
+	}
+
+	void writeSection(uint32_t tag, uint64_t length)
+	{
+		char head[SNAP_SECTION] = {0};
+		encodeUI32(head, tag);
+		encodeUI64(head + 8, length);
+		write(head, SNAP_SECTION);
+	}
+
+	void pad(size_t size)
+	{
+		const char zeros[8] = {0};
+		write(zeros, padOf(size));
+	}
+
+	uint64_t checksum() const
+	{
+		return _hash;
+	}
+
+private:
+	std::ostream      &_out;
+	char               _carry[8];
+	size_t             _carrySize{0};
+	uint64_t           _hash{0};
+};
+
+/// to write CSR sections of graph, with rows packed.
+void writeCsr(SnapshotWriter &writer, const CsrGraph &graph, uint32_t offsetTag)
+{
+	int verNum = graph.verticeNum();
+	VecInt offsets(verNum + 1, 0);
+	for (int i = 0; i < verNum; ++i)
+	{
+		offsets[i + 1] = offsets[i] + graph.edgeEnd(i) - graph.edgeBegin(i);
+	}
+	writer.writeSection(offsetTag, offsets.size() * sizeof(int));
+	writer.write(offsets.data(), offsets.size() * sizeof(int));
+	writer.pad(offsets.size() * sizeof(int));
+
+	// rows are copied through a buffer since they may have idle slots.
+	const size_t bufferSize = 1 << 16;
+	VecInt targets;
+	targets.reserve(bufferSize);
+	writer.writeSection(offsetTag + 1, graph.edgeNum() * sizeof(int));
+	for (int i = 0; i < verNum; ++i)
+	{
+		for (int e = graph.edgeBegin(i); e < graph.edgeEnd(i); ++e)
+		{
+			targets.emplace_back(graph.target(e));
+		}
+		if (targets.size() >= bufferSize || i + 1 == verNum)
+		{
+			writer.write(targets.data(), targets.size() * sizeof(int));
+			targets.clear();
+		}
+	}
+	writer.pad(graph.edgeNum() * sizeof(int));
+
+	VecDbl weights;
+	weights.reserve(bufferSize);
+	writer.writeSection(offsetTag + 2, graph.edgeNum() * sizeof(double));
+	for (int i = 0; i < verNum; ++i)
+	{
+		for (int e = graph.edgeBegin(i); e < graph.edgeEnd(i); ++e)
+		{
+			weights.emplace_back(graph.weight(e));
+		}
+		if (weights.size() >= bufferSize || i + 1 == verNum)
+		{
+			writer.write(weights.data(), weights.size() * sizeof(double));
+			weights.clear();
+		}
+	}
+}
+
+/// if all targets are vertices index.
+bool isValidTargets(const int *targets, uint64_t verNum, uint64_t edgeNum)
+{
+	for (uint64_t e = 0; e < edgeNum; ++e)
+	{
+		if (targets[e] < 0 || static_cast<uint64_t>(targets[e]) >= verNum)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/// to move file over target file, which may be still mapped on POSIX only.
+bool replaceFile(const string &file, const string &target)
+{
+#ifdef WINDOWS
+	return MoveFileExA(file.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return std::rename(file.c_str(), target.c_str()) == 0;
+#endif
+}
+
+/// to check CSR offsets read from snapshot.
+bool isValidOffsets(const int *offsets, uint64_t verNum, uint64_t edgeNum)
+{
+	if (offsets[0] != 0 || static_cast<uint64_t>(offsets[verNum]) != edgeNum)
+	{
+		return false;
+	}
+	for (uint64_t i = 0; i < verNum; ++i)
+	{
+		if (offsets[i + 1] < offsets[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/// edges and vertices parsed from a chunk of file.
+struct Chunk
+{
+	vector<std::string_view> names;     ///< local vertices in order of first seen.
+	vector<CsrEdge> edges;              ///< edges of local vertices index.
+};
+
+bool isBlank(char ch)
+{
+	return ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+/// to read a field ending with separator and skip the separator.
+std::string_view readField(const char *&pos, const char *end)
+{
+	const char *first = pos;
+	while (pos < end && !isBlank(*pos) && *pos != ',')
+	{
+		++pos;
+	}
+	std::string_view field(first, pos - first);
+
+	while (pos < end && isBlank(*pos))
+	{
+		++pos;
+	}
+	if (pos < end && *pos == ',')
+	{
+		++pos;
+		while (pos < end && isBlank(*pos))
+		{
+			++pos;
+		}
+	}
+
+	return field;
+}
+
+/// to parse "begin end value" line; returns false if line is invalid.
+bool parseLine(const char *pos, const char *end, std::string_view &beg,
+               std::string_view &endVer, double &value)
+{
+	beg = readField(pos, end);
+	endVer = readField(pos, end);
+
+	const char *first = pos;
+	while (pos < end && !isBlank(*pos) && *pos != ',')
+	{
+		++pos;
+	}
+	auto res = std::from_chars(first, pos, value);
+	bool isNumber = res.ec == std::errc() && res.ptr == pos;
+	while (pos < end && isBlank(*pos))
+	{
+		++pos;
+	}
+
+	return !beg.empty() && !endVer.empty() && isNumber && pos == end;
+}
+
+}  // end of anonymous namespace.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// class MappedFile.
+/////////////////////////////////////////////////////////////////////////////////
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+#ifdef WINDOWS
+
+bool MappedFile::open(const string &file)
+{
+	close();
+	_file = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+	                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER size;
+	if (_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(_file, &size))
+	{
+		std::cerr << "failed to open file: " << file << _LOCA;
+		close();
+		return false;
+	}
+
+	_size = static_cast<size_t>(size.QuadPart);
+	if (_size == 0)
+	{
+		return true;  // empty file can't be mapped.
+	}
+
+	_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping != nullptr)
+	{
+		_data = static_cast<const char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	if (_data == nullptr)
+	{
+		std::cerr << "failed to map file: " << file << _LOCA;
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_data != nullptr)
+	{
+		UnmapViewOfFile(_data);
+	}
+	if (_mapping != nullptr)
+	{
+		CloseHandle(_mapping);
+	}
+	if (_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(_file);
+	}
+
+	_data = nullptr;
+	_size = 0;
+	_mapping = nullptr;
+	_file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::open(const string &file)
+{
+	close();
+	int fd = ::open(file.c_str(), O_RDONLY);
+	struct stat info;
+	if (fd < 0 || ::fstat(fd, &info) != 0)
+	{
+		std::cerr << "failed to open file: " << file << _LOCA;
+		if (fd >= 0)
+		{
+			::close(fd);
+		}
+		return false;
+	}
+
+	_size = static_cast<size_t>(info.st_size);
+	if (_size > 0)
+	{
+		void *addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED)
+		{
+			std::cerr << "failed to map file: " << file << _LOCA;
+			::close(fd);
+			_size = 0;
+			return false;
+		}
+
+		_data = static_cast<const char *>(addr);
+		::madvise(addr, _size, MADV_SEQUENTIAL);
+	}
+
+	::close(fd);  // mapping stays valid after closing.
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_data != nullptr)
+	{
+		::munmap(const_cast<char *>(_data), _size);
+	}
+
+	_data = nullptr;
+	_size = 0;
+}
+
+#endif
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// class EdgeListLoader.
+/////////////////////////////////////////////////////////////////////////////////
+
+bool EdgeListLoader::load(const string &file, VecStr &verIds, vector<CsrEdge> &edges,
+                          int threadNum)
+{
+	verIds.clear();
+	edges.clear();
+
+	MappedFile mapped;
+	if (!mapped.open(file))
+	{
+		return false;
+	}
+
+	bool isBinary = mapped.size() >= sizeof(EDGES_MAGIC)
+	                && std::memcmp(mapped.data(), EDGES_MAGIC, sizeof(EDGES_MAGIC)) == 0;
+	bool status = isBinary ? loadBinary(mapped, verIds, edges, threadsOf(threadNum))
+	              : loadText(mapped, verIds, edges, threadsOf(threadNum));
+	if (!status)
+	{
+		std::cerr << "invalid edge list file: " << file << _LOCA;
+		verIds.clear();
+		edges.clear();
+	}
+
+	return status;
+}
+
+bool EdgeListLoader::saveBinary(const string &file, const vector<CsrEdge> &edges)
+{
+	std::ofstream out(file, std::ios::binary);
+	if (!out)
+	{
+		std::cerr << "failed to open file: " << file << _LOCA;
+		return false;
+	}
+
+	char header[EDGES_HEADER] = {0};
+	std::memcpy(header, EDGES_MAGIC, sizeof(EDGES_MAGIC));
+	encodeUI32(header + 8, EDGES_VERSION);
+	encodeUI64(header + 16, edges.size());
+	out.write(header, EDGES_HEADER);
+
+	for (const auto &edge : edges)
+	{
+		char record[EDGES_RECORD];
+		uint64_t bits;
+		std::memcpy(&bits, &edge.weight, sizeof(bits));
+		encodeUI32(record, static_cast<uint32_t>(edge.beg));
+		encodeUI32(record + 4, static_cast<uint32_t>(edge.end));
+		encodeUI64(record + 8, bits);
+		out.write(record, EDGES_RECORD);
+	}
+
+	return static_cast<bool>(out);
+}
+
+bool EdgeListLoader::loadText(const MappedFile &mapped, VecStr &verIds,
+                              vector<CsrEdge> &edges, int threadNum)
+{
+	const char *data = mapped.data();
+	size_t size = mapped.size();
+
+	// split file into chunks of whole lines.
+	int chunkNum = static_cast<int>((std::max)(static_cast<size_t>(1),
+	                                (std::min)(static_cast<size_t>(threadNum), size / MIN_CHUNK_SIZE)));
+	vector<size_t> bounds(chunkNum + 1, size);
+	bounds[0] = 0;
+	for (int i = 1; i < chunkNum; ++i)
+	{
+		size_t pos = (std::max)(bounds[i - 1], size / chunkNum * i);
+		const void *lineEnd = (pos < size) ? std::memchr(data + pos, '\n', size - pos) : nullptr;
+		bounds[i] = lineEnd ? static_cast<const char *>(lineEnd) - data + 1 : size;
+	}
+
+	// parse chunks and intern their vertices locally.
+	vector<Chunk> chunks(chunkNum);
+	std::atomic<bool> isValid{true};
+	parallelFor(chunkNum, threadNum, [&](int ind)
+	{
+		Chunk &chunk = chunks[ind];
+		NameTable localInds;
+		auto intern = [&chunk, &localInds](std::string_view name)
+		{
+			int localInd = localInds.intern(name, localInds.size());
+			if (localInd == static_cast<int>(chunk.names.size()))
+			{
+				chunk.names.emplace_back(name);
+			}
+			return localInd;
+		};
+
+		bool isFirstLine = (ind == 0);
+		const char *pos = data + bounds[ind];
+		const char *last = data + bounds[ind + 1];
+		while (pos < last && isValid)
+		{
+			const void *found = std::memchr(pos, '\n', last - pos);
+			const char *lineEnd = found ? static_cast<const char *>(found) : last;
+			const char *first = pos;
+			pos = lineEnd + 1;
+
+			while (first < lineEnd && isBlank(*first))
+			{
+				++first;
+			}
+			if (first == lineEnd || *first == '#')
+			{
+				continue;
+			}
+
+			std::string_view beg, end;
+			double value = 0.0;
+			if (!parseLine(first, lineEnd, beg, end, value))
+			{
+				if (!isFirstLine)
+				{
+					std::cerr << "invalid edge line: " << string(first, lineEnd) << _LOCA;
+					isValid = false;
+				}
+				isFirstLine = false;  // skip header line.
+				continue;
+			}
+			isFirstLine = false;
+
+			int begInd = intern(beg);
+			chunk.edges.push_back({begInd, intern(end), value});
+		}
+	});
+	if (!isValid)
+	{
+		return false;
+	}
+
+	// sort all vertices into global table.
+	NameTable verInds;
+	vector<std::string_view> names;
+	for (const auto &chunk : chunks)
+	{
+		for (const auto &name : chunk.names)
+		{
+			if (verInds.intern(name, verInds.size()) == static_cast<int>(names.size()))
+			{
+				names.emplace_back(name);
+			}
+		}
+	}
+	VecInt order(names.size());
+	for (int i = 0; i < static_cast<int>(order.size()); ++i)
+	{
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&names](int lhs, int rhs)
+	{
+		return names[lhs] < names[rhs];
+	});
+	VecInt ranks(names.size());
+	verIds.reserve(names.size());
+	for (int i = 0; i < static_cast<int>(order.size()); ++i)
+	{
+		ranks[order[i]] = i;
+		verIds.emplace_back(names[order[i]]);
+	}
+
+	// remap local edges into place, in order of file.
+	vector<size_t> offsets(chunkNum + 1, 0);
+	for (int i = 0; i < chunkNum; ++i)
+	{
+		offsets[i + 1] = offsets[i] + chunks[i].edges.size();
+	}
+	edges.resize(offsets.back());
+	parallelFor(chunkNum, threadNum, [&](int ind)
+	{
+		Chunk &chunk = chunks[ind];
+		VecInt globalInds(chunk.names.size());
+		for (size_t i = 0; i < chunk.names.size(); ++i)
+		{
+			globalInds[i] = ranks[verInds.find(chunk.names[i])];
+		}
+		for (size_t i = 0; i < chunk.edges.size(); ++i)
+		{
+			const CsrEdge &edge = chunk.edges[i];
+			edges[offsets[ind] + i] = {globalInds[edge.beg], globalInds[edge.end], edge.weight};
+		}
+		vector<CsrEdge>().swap(chunk.edges);
+	});
+
+	return true;
+}
+
+bool EdgeListLoader::loadBinary(const MappedFile &mapped, VecStr &verIds,
+                                vector<CsrEdge> &edges, int threadNum)
+{
+	const char *data = mapped.data();
+	if (mapped.size() < EDGES_HEADER || decodeUI32(data + 8) != EDGES_VERSION)
+	{
+		return false;
+	}
+	uint64_t edgeNum = decodeUI64(data + 16);
+	if (edgeNum > (mapped.size() - EDGES_HEADER) / EDGES_RECORD
+	        || mapped.size() != EDGES_HEADER + edgeNum * EDGES_RECORD)
+	{
+		return false;
+	}
+	const char *records = data + EDGES_HEADER;
+
+	// collect sorted unique vertices id of each chunk.
+	int chunkNum = static_cast<int>((std::max)(static_cast<uint64_t>(1),
+	                                (std::min)(static_cast<uint64_t>(threadNum),
+	                                           edgeNum * EDGES_RECORD / MIN_CHUNK_SIZE)));
+	auto boundOf = [edgeNum, chunkNum](int ind)
+	{
+		return edgeNum * ind / chunkNum;
+	};
+	vector<vector<uint32_t>> chunkIds(chunkNum);
+	parallelFor(chunkNum, threadNum, [&](int ind)
+	{
+		auto &ids = chunkIds[ind];
+		for (uint64_t i = boundOf(ind); i < boundOf(ind + 1); ++i)
+		{
+			ids.emplace_back(decodeUI32(records + i * EDGES_RECORD));
+			ids.emplace_back(decodeUI32(records + i * EDGES_RECORD + 4));
+		}
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+	});
+
+	vector<uint32_t> ids;
+	for (auto &chunk : chunkIds)
+	{
+		vector<uint32_t> merged;
+		merged.reserve(ids.size() + chunk.size());
+		std::set_union(ids.begin(), ids.end(), chunk.begin(), chunk.end(),
+		               std::back_inserter(merged));
+		ids.swap(merged);
+		vector<uint32_t>().swap(chunk);
+	}
+
+	// vertices are named by decimal id and sorted by name.
+	VecStr names(ids.size());
+	VecInt order(ids.size());
+	for (size_t i = 0; i < ids.size(); ++i)
+	{
+		names[i] = std::to_string(ids[i]);
+		order[i] = static_cast<int>(i);
+	}
+	std::sort(order.begin(), order.end(), [&names](int lhs, int rhs)
+	{
+		return names[lhs] < names[rhs];
+	});
+	VecInt inds(ids.size());
+	verIds.reserve(ids.size());
+	for (int i = 0; i < static_cast<int>(order.size()); ++i)
+	{
+		inds[order[i]] = i;
+		verIds.emplace_back(std::move(names[order[i]]));
+	}
+
+	// dense lookup of vertices index unless ids are sparse.
+	VecInt denseInds;
+	if (!ids.empty() && ids.back() <= 4 * edgeNum + 1024)
+	{
+		denseInds.assign(static_cast<size_t>(ids.back()) + 1, -1);
+		for (size_t i = 0; i < ids.size(); ++i)
+		{
+			denseInds[ids[i]] = inds[i];
+		}
+	}
+	auto indOf = [&ids, &inds, &denseInds](uint32_t id)
+	{
+		return denseInds.empty() ? inds[std::lower_bound(ids.begin(), ids.end(), id) - ids.begin()]
+		       : denseInds[id];
+	};
+
+	edges.resize(edgeNum);
+	parallelFor(chunkNum, threadNum, [&](int ind)
+	{
+		for (uint64_t i = boundOf(ind); i < boundOf(ind + 1); ++i)
+		{
+			const char *record = records + i * EDGES_RECORD;
+			uint64_t bits = decodeUI64(record + 8);
+			double value;
+			std::memcpy(&value, &bits, sizeof(value));
+			edges[i] = {indOf(decodeUI32(record)), indOf(decodeUI32(record + 4)), value};
+		}
+	});
+
+	return true;
+}
+
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// class GraphSnapshot.
+/////////////////////////////////////////////////////////////////////////////////
+
+bool GraphSnapshot::save(const string &file, const VecStr &verIds, const CsrGraph &graph,
+                         const CsrGraph &reverseGraph)
+{
+	// graph may be attached to the file itself, so a temp file is written and
+	// moved over it at last.
+	const string tempFile = file + ".tmp";
+	std::ofstream out(tempFile, std::ios::binary);
+	if (!out)
+	{
+		std::cerr << "failed to open file: " << tempFile << _LOCA;
+		return false;
+	}
+
+	// header is rewritten with checksum at last.
+	char header[SNAP_HEADER] = {0};
+	out.write(header, SNAP_HEADER);
+	SnapshotWriter writer(out);
+
+	vector<uint64_t> nameOffsets(verIds.size() + 1, 0);
+	for (size_t i = 0; i < verIds.size(); ++i)
+	{
+		nameOffsets[i + 1] = nameOffsets[i] + verIds[i].size();
+	}
+	writer.writeSection(TAG_NAME_OFFSETS, nameOffsets.size() * sizeof(uint64_t));
+	writer.write(nameOffsets.data(), nameOffsets.size() * sizeof(uint64_t));
+	writer.writeSection(TAG_NAME_CHARS, nameOffsets.back());
+	for (const auto &verId : verIds)
+	{
+		writer.write(verId.data(), verId.size());
+	}
+	writer.pad(nameOffsets.back());
+
+	writeCsr(writer, graph, TAG_OFFSETS);
+	writeCsr(writer, reverseGraph, TAG_REV_OFFSETS);
+
+	std::memcpy(header, SNAP_MAGIC, sizeof(SNAP_MAGIC));
+	encodeUI32(header + 8, SNAP_VERSION);
+	std::memcpy(header + 12, &SNAP_BYTE_ORDER, sizeof(SNAP_BYTE_ORDER));
+	encodeUI64(header + 16, verIds.size());
+	encodeUI64(header + 24, graph.edgeNum());
+	encodeUI32(header + 32, TAG_NUM - 1);
+	encodeUI64(header + 40, writer.checksum());
+	out.seekp(0);
+	out.write(header, SNAP_HEADER);
+	out.close();
+
+	if (!out || !replaceFile(tempFile, file))
+	{
+		std::remove(tempFile.c_str());
+		std::cerr << "failed to write file: " << file << _LOCA;
+		return false;
+	}
+	return true;
+}
+
+bool GraphSnapshot::load(const string &file, VecStr &verIds, CsrGraph &graph,
+                         CsrGraph &reverseGraph, bool isVerified)
+{
+	auto mapped = std::make_shared<MappedFile>();
+	if (!mapped->open(file))
+	{
+		return false;
+	}
+
+	auto fail = [&file]()
+	{
+		std::cerr << "invalid graph snapshot: " << file << _LOCA;
+		return false;
+	};
+
+	const char *data = mapped->data();
+	size_t size = mapped->size();
+	uint32_t byteOrder = 0;
+	if (size < SNAP_HEADER || (size - SNAP_HEADER) % 8 != 0
+	        || std::memcmp(data, SNAP_MAGIC, sizeof(SNAP_MAGIC)) != 0
+	        || decodeUI32(data + 8) != SNAP_VERSION)
+	{
+		return fail();
+	}
+	std::memcpy(&byteOrder, data + 12, sizeof(byteOrder));
+	uint64_t verNum = decodeUI64(data + 16);
+	uint64_t edgeNum = decodeUI64(data + 24);
+	uint32_t sectionNum = decodeUI32(data + 32);
+	if (byteOrder != SNAP_BYTE_ORDER || verNum >= INT32_MAX || edgeNum >= INT32_MAX)
+	{
+		return fail();  // arrays can't be used in place.
+	}
+	if (isVerified && mixWords(0, data + SNAP_HEADER, size - SNAP_HEADER) != decodeUI64(data + 40))
+	{
+		return fail();
+	}
+
+	// locate known sections and check their length.
+	const char *sections[TAG_NUM] = {nullptr};
+	uint64_t lengths[TAG_NUM] = {0};
+	size_t pos = SNAP_HEADER;
+	for (uint32_t i = 0; i < sectionNum; ++i)
+	{
+		if (size - pos < SNAP_SECTION)
+		{
+			return fail();
+		}
+		uint32_t tag = decodeUI32(data + pos);
+		uint64_t length = decodeUI64(data + pos + 8);
+		pos += SNAP_SECTION;
+		if (length > size - pos)
+		{
+			return fail();
+		}
+		if (tag > 0 && tag < TAG_NUM)
+		{
+			sections[tag] = data + pos;
+			lengths[tag] = length;
+		}
+		pos += length + padOf(length);
+	}
+
+	uint64_t expected[TAG_NUM] = {0, (verNum + 1) * sizeof(uint64_t), lengths[TAG_NAME_CHARS],
+	                              (verNum + 1) * sizeof(int), edgeNum * sizeof(int), edgeNum * sizeof(double),
+	                              (verNum + 1) * sizeof(int), edgeNum * sizeof(int), edgeNum * sizeof(double)
+	                             };
+	for (uint32_t tag = 1; tag < TAG_NUM; ++tag)
+	{
+		if (sections[tag] == nullptr || lengths[tag] != expected[tag])
+		{
+			return fail();
+		}
+	}
+
+	const auto *nameOffsets = reinterpret_cast<const uint64_t *>(sections[TAG_NAME_OFFSETS]);
+	const auto *offsets = reinterpret_cast<const int *>(sections[TAG_OFFSETS]);
+	const auto *revOffsets = reinterpret_cast<const int *>(sections[TAG_REV_OFFSETS]);
+	const auto *targets = reinterpret_cast<const int *>(sections[TAG_TARGETS]);
+	const auto *revTargets = reinterpret_cast<const int *>(sections[TAG_REV_TARGETS]);
+	if (nameOffsets[0] != 0 || nameOffsets[verNum] != lengths[TAG_NAME_CHARS]
+	        || !isValidOffsets(offsets, verNum, edgeNum)
+	        || !isValidOffsets(revOffsets, verNum, edgeNum)
+	        || !isValidTargets(targets, verNum, edgeNum)
+	        || !isValidTargets(revTargets, verNum, edgeNum))
+	{
+		return fail();
+	}
+
+	verIds.clear();
+	verIds.reserve(verNum);
+	for (uint64_t i = 0; i < verNum; ++i)
+	{
+		if (nameOffsets[i + 1] < nameOffsets[i])
+		{
+			verIds.clear();
+			return fail();
+		}
+		verIds.emplace_back(sections[TAG_NAME_CHARS] + nameOffsets[i], nameOffsets[i + 1] - nameOffsets[i]);
+	}
+
+	graph.attach(mapped, static_cast<int>(verNum), static_cast<int>(edgeNum), offsets, targets,
+	             reinterpret_cast<const double *>(sections[TAG_WEIGHTS]));
+	reverseGraph.attach(mapped, static_cast<int>(verNum), static_cast<int>(edgeNum), revOffsets,
+	                    revTargets, reinterpret_cast<const double *>(sections[TAG_REV_WEIGHTS]));
+
+	return true;
+}
+
+}  // end of namespace ccb.
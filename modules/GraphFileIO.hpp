@@ -0,0 +1,110 @@
+/** *****************************************************************************
+*   @copyright :  Copyright (C) 2026 Qin ZhaoYu. All rights reserved.
+*
+*   @author    :  Qin ZhaoYu.
+*   @see       :  https://github.com/QINZHAOYU
+*   @brief     :  To load directed graph from large files via memory mapping.
+*
+*   Change History:
+*   -----------------------------------------------------------------------------
+*   v1.0, 2026/10/17, Qin ZhaoYu, zhaoyu.qin@foxmail.com
+*   Init model.
+*
+** ******************************************************************************/
+
+#pragma once
+#include "common/CommHeader.hpp"
+#include "common/CommStructs.hpp"
+#include "GraphSearchingAlgo.hpp"
+#include <cstdint>
+
+
+/// \brief namespace of cpp code box.
+namespace ccb
+{
+
+/// \brief Read-only memory mapping of a whole file.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+	~MappedFile();
+
+	bool open(const string &file);
+	void close();
+
+	const char *data() const
+	{
+		return _data;
+	}
+	size_t size() const
+	{
+		return _size;
+	}
+
+private:
+	const char        *_data{nullptr};      // first byte of mapped file.
+	size_t             _size{0};            // bytes of mapped file.
+#ifdef WINDOWS
+	HANDLE             _file{INVALID_HANDLE_VALUE};  // file handle.
+	HANDLE             _mapping{nullptr};   // file mapping handle.
+#endif
+};
+
+
+/// \brief To parse edge list file into interned vertices and CSR edges.
+///
+/// \details Text file has one edge "begin end value" per line, separated by
+///        comma, tab or spaces; blank lines and lines starting with '#' are
+///        skipped, and so is the first line if its value isn't a number(a
+///        CSV header). Binary file starts with magic "CCBEDGES", version and
+///        edges number, followed by little-endian records of uint32 begin,
+///        uint32 end and float64 value; vertices are named by their decimal id.
+///
+///        File is memory mapped and split into chunks parsed by threads, each
+///        interning names as views into the mapping, so no string is copied
+///        until the final sorted vertices table is built.
+class EdgeListLoader
+{
+public:
+	static bool load(const string &file, VecStr &verIds, vector<CsrEdge> &edges,
+	                 int threadNum = 0);
+	static bool saveBinary(const string &file, const vector<CsrEdge> &edges);
+
+private:
+	static bool loadText(const MappedFile &mapped, VecStr &verIds,
+	                     vector<CsrEdge> &edges, int threadNum);
+	static bool loadBinary(const MappedFile &mapped, VecStr &verIds,
+	                       vector<CsrEdge> &edges, int threadNum);
+};
+
+
+/// \brief Versioned binary snapshot of interned vertices and CSR graphs.
+///
+/// \details Layout follows "file header + tagged sections" of IOBinaryFormat.md:
+///        header has magic "CCBGRAPH", version, byte order tag, vertices and
+///        edges number, sections number and checksum of all sections; each
+///        section has a tag and data length, with data padded to 8 bytes.
+///        Sections are vertices names, CSR offsets, targets and weights of
+///        graph and of its reverse; sections of unknown tag are skipped.
+///
+///        Arrays are stored in native byte order and aligned, so that loaded
+///        graphs are attached to the mapped file and used without parsing;
+///        offsets and targets are still checked in range, even unverified.
+///        A snapshot is written to a temp file and moved over the target, so
+///        the file a graph is attached to can be saved over on POSIX.
+///
+/// \attention On Windows a mapped file can't be replaced, so that saving over
+///        the file a graph is attached to fails and leaves the file as it was.
+class GraphSnapshot
+{
+public:
+	static bool save(const string &file, const VecStr &verIds, const CsrGraph &graph,
+	                 const CsrGraph &reverseGraph);
+	static bool load(const string &file, VecStr &verIds, CsrGraph &graph,
+	                 CsrGraph &reverseGraph, bool isVerified = true);
+};
+
+}  // end of namespace ccb.
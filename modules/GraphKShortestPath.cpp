@@ -0,0 +1,245 @@
+/** *****************************************************************************
+*    @File      :  GraphKShortestPath.cpp
+*    @Brief     :  To search top k loopless shortest pathes between two vertices.
+*
+** ******************************************************************************/
+
+#include "common/CommConsts.hpp"
+#include "GraphKShortestPath.hpp"
+#include <queue>
+#include <set>
+
+
+namespace ccb
+{
+
+/////////////////////////////////////////////////////////////////////////////////
+// class KShortestPathes.
+/////////////////////////////////////////////////////////////////////////////////
+
+KShortestPathes::KShortestPathes(const ShortestPathEngine &engine)
+	: _engine(engine)
+{
+}
+
+bool KShortestPathes::YenAlgo(int begVerticeInd, int endVerticeInd, int k,
+                              vector<VecInt> &routes, VecDbl &lengths)
+{
+	routes.clear();
+	lengths.clear();
+
+	int size = _engine.graph().verticeNum();
+	if (k < 1 || begVerticeInd < 0 || begVerticeInd >= size
+	        || endVerticeInd < 0 || endVerticeInd >= size)
+	{
+		return false;
+	}
+
+	if (endVerticeInd != _endVerticeInd || static_cast<int>(_toEnd.size()) != size)
+	{
+		searchReverseTree(endVerticeInd);
+	}
+	if (_toEnd[begVerticeInd] == _DBL_MAX)
+	{
+		return false;
+	}
+
+	if (static_cast<int>(_isBanned.size()) != size)
+	{
+		_isBanned.assign(size, false);
+		_dist.assign(size, _DBL_MAX);
+		_path.assign(size, -1);
+		_touched.clear();
+	}
+	_heap.resize(size);
+
+	// the shortest path follows reverse tree.
+	VecInt first{begVerticeInd};
+	for (int ver = begVerticeInd; ver != endVerticeInd; )
+	{
+		ver = _toNext[ver];
+		first.emplace_back(ver);
+	}
+
+	std::priority_queue<Candidate, vector<Candidate>, std::greater<Candidate>> candidates;
+	std::set<VecInt> knownRoutes;  // routes accepted or queued.
+	candidates.push({lengthOf(first), first, 0});
+	knownRoutes.insert(first);
+
+	_trie.assign(1, TrieNode{begVerticeInd, VecInt()});
+	VecInt spurRoute;
+	while (static_cast<int>(routes.size()) < k && !candidates.empty())
+	{
+		Candidate best = candidates.top();
+		candidates.pop();
+		routes.emplace_back(std::move(best.route));
+		lengths.emplace_back(best.length);
+		if (static_cast<int>(routes.size()) == k)
+		{
+			break;
+		}
+
+		// its own next edges are removed from spur searches as well.
+		const VecInt &route = routes.back();
+		insertPath(route);
+
+		// split at each vertice from where it deviates from its parent.
+		int node = 0;
+		double rootLength = 0.0;
+		for (size_t i = 0; i + 1 < route.size(); ++i)
+		{
+			if (static_cast<int>(i) >= best.deviation
+			        && searchSpurPath(route[i], endVerticeInd, node, spurRoute))
+			{
+				VecInt candidate(route.begin(), route.begin() + i);
+				candidate.insert(candidate.end(), spurRoute.begin(), spurRoute.end());
+				if (knownRoutes.insert(candidate).second)
+				{
+					double length = rootLength + lengthOf(spurRoute);
+					candidates.push({length, std::move(candidate), static_cast<int>(i)});
+				}
+			}
+
+			// extend root path by one edge.
+			_isBanned[route[i]] = true;
+			rootLength += _engine.graph().findWeight(route[i], route[i + 1]);
+			for (int child : _trie[node].children)
+			{
+				if (_trie[child].ver == route[i + 1])
+				{
+					node = child;
+					break;
+				}
+			}
+		}
+
+		for (int ver : route)
+		{
+			_isBanned[ver] = false;
+		}
+	}
+
+	return true;
+}
+
+void KShortestPathes::searchReverseTree(int endVerticeInd)
+{
+	// shortest pathes to end vertice are searched on reverse graph.
+	ShortestPathEngine reverseEngine = _engine.reversed();
+	DijkstraWorkspace workspace;
+	reverseEngine.DijkstraAlgo(endVerticeInd, -1, workspace);
+
+	_toEnd = std::move(workspace.dist);
+	_toNext = std::move(workspace.path);
+	_endVerticeInd = endVerticeInd;
+}
+
+void KShortestPathes::insertPath(const VecInt &route)
+{
+	int node = 0;
+	for (size_t i = 1; i < route.size(); ++i)
+	{
+		int next = -1;
+		for (int child : _trie[node].children)
+		{
+			if (_trie[child].ver == route[i])
+			{
+				next = child;
+				break;
+			}
+		}
+
+		if (next < 0)
+		{
+			next = static_cast<int>(_trie.size());
+			_trie[node].children.emplace_back(next);
+			_trie.push_back(TrieNode{route[i], VecInt()});
+		}
+		node = next;
+	}
+}
+
+bool KShortestPathes::searchSpurPath(int spurVerticeInd, int endVerticeInd, int rootNode,
+                                     VecInt &spurRoute)
+{
+	for (int ver : _touched)
+	{
+		_dist[ver] = _DBL_MAX;
+		_path[ver] = -1;
+	}
+	_touched.clear();
+	_heap.clear();
+
+	// Dijkstra algorithm on reduced edge values w(u, v) + toEnd(v) - toEnd(u),
+	// which are non-negative, up to rounding, and zero along reverse tree.
+	const CsrGraph &graph = _engine.graph();
+	auto isRootNext = [this, rootNode](int ver)
+	{
+		const VecInt &children = _trie[rootNode].children;
+		return std::any_of(children.begin(), children.end(), [this, ver](int child)
+		{
+			return _trie[child].ver == ver;
+		});
+	};
+
+	_dist[spurVerticeInd] = 0.0;
+	_path[spurVerticeInd] = spurVerticeInd;
+	_touched.emplace_back(spurVerticeInd);
+	_heap.push(spurVerticeInd, 0.0);
+	while (!_heap.empty())
+	{
+		int postVerInd = _heap.pop();
+		if (postVerInd == endVerticeInd)
+		{
+			break;
+		}
+
+		for (int e = graph.edgeBegin(postVerInd); e < graph.edgeEnd(postVerInd); ++e)
+		{
+			int j = graph.target(e);
+			if (_isBanned[j] || _toEnd[j] == _DBL_MAX)
+			{
+				continue;  // on root path or never reaching end vertice.
+			}
+			if (postVerInd == spurVerticeInd && isRootNext(j))
+			{
+				continue;  // next edge of accepted pathes sharing the root.
+			}
+
+			double reduced = graph.weight(e) + _toEnd[j] - _toEnd[postVerInd];
+			double currDist = _dist[postVerInd] + (std::max)(reduced, 0.0);
+			if (currDist < _dist[j])
+			{
+				if (_path[j] < 0)
+				{
+					_touched.emplace_back(j);
+				}
+				_dist[j] = currDist;
+				_path[j] = postVerInd;
+				_heap.push(j, currDist);
+			}
+		}
+	}
+
+	if (_path[endVerticeInd] < 0)
+	{
+		return false;
+	}
+
+	spurRoute = ShortestPathEngine::parsePath(_path, spurVerticeInd, endVerticeInd);
+	return true;
+}
+
+double KShortestPathes::lengthOf(const VecInt &route) const
+{
+	// summed by edge values, free of rounding of reduced values.
+	double length = 0.0;
+	for (size_t i = 1; i < route.size(); ++i)
+	{
+		length += _engine.graph().findWeight(route[i - 1], route[i]);
+	}
+
+	return length;
+}
+
+}  // end of namespace ccb.
@@ -0,0 +1,95 @@
+/** *****************************************************************************
+*   @copyright :  Copyright (C) 2026 Qin ZhaoYu. All rights reserved.
+*
+*   @author    :  Qin ZhaoYu.
+*   @see       :  https://github.com/QINZHAOYU
+*   @brief     :  To search top k loopless shortest pathes between two vertices.
+*
+*   Change History:
+*   -----------------------------------------------------------------------------
+*   v1.0, 2026/10/17, Qin ZhaoYu, zhaoyu.qin@foxmail.com
+*   Init model.
+*
+** ******************************************************************************/
+
+#pragma once
+#include "common/CommHeader.hpp"
+#include "common/CommStructs.hpp"
+#include "GraphSearchingAlgo.hpp"
+
+
+/// \brief namespace of cpp code box.
+namespace ccb
+{
+
+/// \brief Top k loopless shortest pathes between two vertices by Yen's algorithm.
+///
+/// \details Each accepted path is split at every vertice(spur vertice) into a
+///        root path and a spur path searched with the root's vertices and the
+///        next edges of accepted pathes sharing the root removed; the shortest
+///        candidate is accepted next.
+///
+///        Spur searches are guided by exact lengths to end vertice from one
+///        reverse shortest path tree, which is a consistent heuristic since
+///        removing vertices and edges never shortens a path, so each spur
+///        search settles few vertices and works with negative edge values as
+///        well. Accepted pathes are kept in a prefix tree with prefix lengths,
+///        so removed edges of a root are looked up at once, and a path is only
+///        split from the vertice where it deviates from its parent(Lawler),
+///        since earlier spur pathes were searched for the parent already.
+///
+///        Scratch state is kept between searches, and so is the reverse tree
+///        while end vertice is the same.
+///
+/// \attention The engine must outlive this object and its graph must not
+///        change between searches; a new object is needed otherwise.
+class KShortestPathes
+{
+public:
+	explicit KShortestPathes(const ShortestPathEngine &engine);
+
+	bool YenAlgo(int begVerticeInd, int endVerticeInd, int k, vector<VecInt> &routes,
+	             VecDbl &lengths);
+
+private:
+	/// accepted path in prefix tree.
+	struct TrieNode
+	{
+		int    ver;       ///< vertice index.
+		VecInt children;  ///< nodes of next vertices.
+	};
+
+	/// candidate path with its length and deviation index from parent.
+	struct Candidate
+	{
+		double length;    ///< path length.
+		VecInt route;     ///< vertices index of path.
+		int    deviation; ///< index of spur vertice.
+
+		bool operator>(const Candidate &other) const
+		{
+			return (length != other.length) ? length > other.length : route > other.route;
+		}
+	};
+
+	void searchReverseTree(int endVerticeInd);
+	void insertPath(const VecInt &route);
+	bool searchSpurPath(int spurVerticeInd, int endVerticeInd, int rootNode,
+	                    VecInt &spurRoute);
+	double lengthOf(const VecInt &route) const;
+
+private:
+	const ShortestPathEngine &_engine;  // forward graph and its queries.
+	int                _endVerticeInd{-1};  // end vertice of reverse tree.
+	VecDbl             _toEnd;              // path length to end vertice, INF if none.
+	VecInt             _toNext;             // next vertice in shortest path to end vertice.
+
+	vector<TrieNode>   _trie;               // accepted pathes, root node is begin vertice.
+	VecBool            _isBanned;           // vertices of current root path.
+	VecDbl             _dist;               // reduced path length of spur search.
+	VecInt             _path;               // previous vertice in spur search.
+	VecInt             _touched;            // vertices touched by spur search.
+	IndexedMinHeap     _heap;               // heap of spur search.
+};
+
+}  // end of namespace ccb.
@@ -15,54 +15,584 @@
 #pragma once
 #include "common/CommHeader.hpp"
 #include "common/CommStructs.hpp"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <string_view>
 
 
 /// \brief namespace of cpp code box.
 namespace ccb
 {
 
+/// \brief Directed edge used to build compressed sparse row graph.
+struct CsrEdge
+{
+	int    beg;     ///< begin vertice index.
+	int    end;     ///< end vertice index.
+	double weight;  ///< edge value(weight).
+};
+
+
+/// \brief Directed graph stored in compressed sparse row(CSR) format.
+///
+/// \details Out edges of vertice `v` are stored in [edgeBegin(v), edgeEnd(v)),
+///        sorted by end vertice index, so memory is proportional to edges.
+///
+///        Each row may keep idle slots after its edges, so edges are inserted,
+///        erased or reweighted in place; a full row moves to the tail with
+///        doubled capacity, and idle slots are reclaimed once they exceed half
+///        of all slots, which keeps updates amortized O(degree).
+///
+///        Arrays owned by others, e.g. a mapped snapshot file, can be attached
+///        and read in place; they are copied on first modification.
+class CsrGraph
+{
+public:
+	CsrGraph() = default;
+	CsrGraph(const CsrGraph &other);
+	CsrGraph(CsrGraph &&other) noexcept;
+	CsrGraph &operator=(const CsrGraph &other);
+	CsrGraph &operator=(CsrGraph &&other) noexcept;
+
+	void build(int verticeNum, const vector<CsrEdge> &edges);
+	void attach(shared_ptr<const void> keepalive, int verticeNum, int edgeNum,
+	            const int *offsets, const int *targets, const double *weights);
+	void clear();
+
+	int verticeNum() const
+	{
+		return _verticeNum;
+	}
+	int edgeNum() const
+	{
+		return _edgeNum;
+	}
+	bool isAttached() const
+	{
+		return _keepalive != nullptr;
+	}
+
+	int edgeBegin(int ver) const
+	{
+		return _beginData[ver];
+	}
+	int edgeEnd(int ver) const
+	{
+		return _endData[ver];
+	}
+	int target(int edge) const
+	{
+		return _targetData[edge];
+	}
+	double weight(int edge) const
+	{
+		return _weightData[edge];
+	}
+
+	int findEdge(int beg, int end) const;
+	double findWeight(int beg, int end) const;
+	CsrGraph reversed() const;
+
+	int addVertice();
+	bool insertEdge(int beg, int end, double weight);
+	bool eraseEdge(int beg, int end);
+	bool setWeight(int beg, int end, double weight);
+
+private:
+	void detach();
+	void refreshViews();
+	void moveRow(int ver, int capacity);
+	void compact();
+
+private:
+	VecInt             _begins;             // first slot of each vertice's out edges.
+	VecInt             _ends;               // end of each vertice's out edges.
+	VecInt             _limits;             // end of each vertice's slots.
+	VecInt             _targets;            // end vertice of each edge.
+	VecDbl             _weights;            // value(weight) of each edge.
+	int                _verticeNum{0};      // number of vertices.
+	int                _edgeNum{0};         // number of edges.
+	int                _idleSlots{0};       // slots not owned by any row.
+
+	shared_ptr<const void> _keepalive;      // owner of attached arrays.
+	const int         *_beginData{nullptr}; // view of begins, owned or attached.
+	const int         *_endData{nullptr};   // view of ends.
+	const int         *_targetData{nullptr};  // view of targets.
+	const double      *_weightData{nullptr};  // view of weights.
+};
+
+
+/// \brief Binary min-heap of vertices index supporting decrease-key.
+class IndexedMinHeap
+{
+public:
+	void resize(int capacity);
+	void clear();
+
+	bool empty() const
+	{
+		return _heap.empty();
+	}
+	size_t size() const
+	{
+		return _heap.size();
+	}
+	double topKey() const
+	{
+		return _heap.front().first;
+	}
+
+	void push(int ver, double key);
+	int pop();
+
+private:
+	void siftUp(int pos);
+	void siftDown(int pos);
+
+private:
+	vector<std::pair<double, int>> _heap;   // pairs of key and vertice index.
+	VecInt             _pos;                // position of vertice in heap, -1 if absent.
+};
+
+
+/// \brief Monotone radix heap for non-negative integral keys.
+///
+/// \attention Popped keys must be non-decreasing, which holds for Dijkstra;
+///        outdated entries are not removed and must be skipped by caller.
+class RadixHeap
+{
+public:
+	void reset();
+
+	bool empty() const
+	{
+		return _size == 0;
+	}
+
+	void push(int ver, double key);
+	int pop();
+
+private:
+	using Bucket = vector<std::pair<uint64_t, int>>;
+
+	static int bucketIndex(uint64_t key, uint64_t last);
+
+private:
+	array<Bucket, 65>  _buckets;            // buckets by highest differing bit.
+	uint64_t           _last{0};            // last popped key.
+	size_t             _size{0};            // number of entries.
+};
+
+
+/// \brief Connected components of directed graph, without recursion.
+///
+/// \details Weak components are merged by union-find over edges and strong
+///        components are found by Tarjan algorithm with an explicit stack, both
+///        in near-linear time and no limit of recursion depth.
+class GraphConnectivity
+{
+public:
+	static int weakComponents(const CsrGraph &graph, VecInt &components);
+	static int strongComponents(const CsrGraph &graph, VecInt &components);
+
+private:
+	static int findRoot(VecInt &parents, int ver);
+};
+
+
+/// \brief Search space counters of shortest path queries.
+struct SearchStats
+{
+	size_t queryNum{0};         ///< number of searches.
+	size_t settledVertices{0};  ///< number of vertices settled(popped from heap).
+	size_t relaxedEdges{0};     ///< number of edges relaxed.
+};
+
+
+/// \brief Reusable scratch state of Dijkstra algorithm.
+///
+/// \details Only entries touched by last query are reset in `prepare()`, so
+///        repeated queries on the same graph run without allocation.
+struct DijkstraWorkspace
+{
+	VecDbl         dist;       ///< path length from source vertice to all others.
+	VecBool        book;       ///< vertices with known shortest path.
+	VecInt         path;       ///< previous vertice in shortest path of each vertices.
+	VecInt         touched;    ///< vertices touched by last query.
+	VecInt         hops;       ///< edges number of path, in Bellman-Ford algorithm.
+	std::deque<int> queue;     ///< vertices to scan, in Bellman-Ford algorithm.
+	IndexedMinHeap heap;       ///< heap for real edge values.
+	RadixHeap      radixHeap;  ///< heap for integral edge values.
+	SearchStats    stats;      ///< counters accumulated over queries.
+
+	void prepare(int verticeNum, int begVerticeInd);
+	void touch(int ver, double verDist, int preVer);
+};
+
+
+/// \brief Shortest path tree from one source vertice to all others.
+struct ShortestPathTree
+{
+	int    source{-1};  ///< source vertice index.
+	VecDbl dist;        ///< path length from source vertice, INF if unreachable.
+	VecInt path;        ///< previous vertice in shortest path, -1 if unreachable.
+};
+
+
+class PathStore;
+
+
+/// \brief Read-only view of one path in `PathStore`.
+class PathView
+{
+public:
+	PathView(const PathStore &store, size_t ind);
+
+	size_t size() const
+	{
+		return static_cast<size_t>(_last - _first);
+	}
+	const int *begin() const
+	{
+		return _first;
+	}
+	const int *end() const
+	{
+		return _last;
+	}
+	int operator[](size_t pos) const
+	{
+		return _first[pos];
+	}
+	double cost() const
+	{
+		return _cost;
+	}
+
+	std::string_view name(size_t pos) const;
+
+private:
+	const PathStore   *_store;              // store of the path.
+	const int         *_first;              // first vertice index of path.
+	const int         *_last;               // end of vertices index of path.
+	double             _cost;               // path length.
+};
+
+
+/// \brief Flat store of pathes with their costs.
+///
+/// \details Vertices index of all pathes are kept in one array, path `i` in
+///        [offsets[i], offsets[i+1]), so appending many pathes needs no
+///        allocation once capacity is reached. Vertices are named by views
+///        into an interned table, which stay valid until vertices change.
+class PathStore
+{
+public:
+	void clear();
+	void reserve(size_t pathNum, size_t verticeNum);
+	void setNames(const VecStr *names);
+
+	size_t size() const
+	{
+		return _costs.size();
+	}
+	bool empty() const
+	{
+		return _costs.empty();
+	}
+	PathView operator[](size_t ind) const
+	{
+		return PathView(*this, ind);
+	}
+
+	void append(const int *first, const int *last, double cost);
+	void append(const PathView &path);
+	void appendFromTree(const VecInt &path, int begVerticeInd, int endVerticeInd, double cost);
+
+	std::string_view name(int ver) const;
+
+private:
+	friend class PathView;
+
+	VecInt             _offsets{0};         // first vertice of each path, and end of last.
+	VecInt             _vertices;           // vertices index of all pathes.
+	VecDbl             _costs;              // length of each path.
+	const VecStr      *_names{nullptr};     // interned vertices names, by index.
+};
+
+
+/// \brief Search mode of single pair shortest path queries.
+enum class SearchMode
+{
+	Dijkstra,       ///< plain Dijkstra algorithm from begin vertice.
+	Bidirectional,  ///< Dijkstra algorithm from both begin and end vertices.
+	AStar,          ///< A* algorithm guided by heuristic.
+	ContractionHierarchy,  ///< upward search in preprocessed contraction hierarchies.
+};
+
+
+class ContractionHierarchy;
+
+
+/// \brief Thread-safe shortest path queries over an immutable graph snapshot.
+///
+/// \details All queries are const and keep scratch state in caller's workspace,
+///        so one engine can be shared by many threads; batch queries are spread
+///        over a pool of threads, each owning its workspace.
+///
+///        Single pair queries run in the engine's search mode; bidirectional
+///        mode searches the reverse graph from end vertice as well, and A*
+///        mode needs an admissible heuristic estimating the remaining length.
+///        Contraction hierarchies mode falls back to Dijkstra algorithm until
+///        a hierarchy of current graph is set.
+///
+///        Negative edge values are found once when graph is set, and then
+///        Johnson potentials h(v) are computed by Bellman-Ford algorithm, so
+///        that Dijkstra algorithm runs on non-negative reduced edge values
+///        w(u, v) + h(u) - h(v). Once an update breaks the potentials, they
+///        are recomputed from old ones on the update, so that queries never
+///        reweight; only with a negative cycle do queries fall back to
+///        Bellman-Ford algorithm(SPFA).
+class ShortestPathEngine
+{
+public:
+	/// heuristic(ver, endVer) never overestimates path length from ver to endVer.
+	using Heuristic = std::function<double(int ver, int endVer)>;
+
+	ShortestPathEngine();
+	ShortestPathEngine(shared_ptr<const CsrGraph> graph,
+	                   shared_ptr<const CsrGraph> reverseGraph);
+
+	const CsrGraph &graph() const
+	{
+		return *_graph;
+	}
+
+	ShortestPathEngine reversed() const;
+
+	void setGraph(shared_ptr<const CsrGraph> graph, shared_ptr<const CsrGraph> reverseGraph);
+	void notifyGraphChanged();
+	void notifyEdgeChanged(int begVerticeInd, int endVerticeInd, double oldWeight,
+	                       double newWeight);
+	bool reweight();
+	void setSearchMode(SearchMode mode);
+	void setHeuristic(const Heuristic &heuristic);
+	void setHierarchy(shared_ptr<const ContractionHierarchy> hierarchy);
+
+	shared_ptr<const ContractionHierarchy> hierarchy() const
+	{
+		return _hierarchy;
+	}
+	bool hasNegativeEdge() const
+	{
+		return _negativeEdgeNum > 0;
+	}
+	bool hasNegativeCycle() const
+	{
+		return _hasNegativeCycle;
+	}
+	bool isReweighted() const
+	{
+		return _isReweighted;
+	}
+
+	bool searchPath(int begVerticeInd, int endVerticeInd, DijkstraWorkspace &workspace,
+	                DijkstraWorkspace &backWorkspace, VecInt &route) const;
+	void DijkstraAlgo(int begVerticeInd, int endVerticeInd,
+	                  DijkstraWorkspace &workspace) const;
+	bool BellmanFordAlgo(int begVerticeInd, DijkstraWorkspace &workspace) const;
+	vector<VecInt> searchPathes(const vector<array<int, 2>> &vertices,
+	                            int threadNum = 0, SearchStats *stats = nullptr) const;
+	void searchPathes(const vector<array<int, 2>> &vertices, PathStore &pathes,
+	                  int threadNum = 0, SearchStats *stats = nullptr) const;
+
+	double pathLength(const VecInt &route) const;
+
+	static VecInt parsePath(const VecInt &path, int begVerticeInd, int endVerticeInd);
+
+private:
+	template<typename Heap, typename WeightOf>
+	void DijkstraAlgo(int begVerticeInd, int endVerticeInd, DijkstraWorkspace &workspace,
+	                  Heap &heap, const WeightOf &weightOf) const;
+	double potential(int ver) const
+	{
+		return (ver < static_cast<int>(_potentials->size())) ? (*_potentials)[ver] : 0.0;
+	}
+	void AStarAlgo(int begVerticeInd, int endVerticeInd,
+	               DijkstraWorkspace &workspace) const;
+	int bidirectionalAlgo(int begVerticeInd, int endVerticeInd,
+	                      DijkstraWorkspace &workspace, DijkstraWorkspace &backWorkspace) const;
+
+private:
+	shared_ptr<const CsrGraph> _graph;      // immutable graph snapshot.
+	shared_ptr<const CsrGraph> _reverseGraph;  // graph with reversed edges.
+	bool               _isIntegral{false};  // if all edge values are integral.
+	int                _negativeEdgeNum{0}; // number of negative edge values.
+	bool               _hasNegativeCycle{false};  // if last reweighting found negative cycle.
+	bool               _isReweighted{false};  // if potentials are valid for all edges.
+	shared_ptr<const VecDbl> _potentials;   // Johnson potentials, 0.0 for new vertices.
+	SearchMode         _mode{SearchMode::Dijkstra};  // single pair search mode.
+	Heuristic          _heuristic;          // heuristic of A* algorithm.
+	shared_ptr<const ContractionHierarchy> _hierarchy;  // hierarchy of current graph.
+};
+
+
+/// \brief Status of graph queries.
+enum class GraphStatus
+{
+	Ok,               ///< pathes found.
+	InvalidVertice,   ///< unknown begin or end vertice.
+	InvalidArgument,  ///< invalid argument, e.g. k < 1 pathes.
+	EmptyGraph,       ///< graph has no vertice.
+	NegativeCycle,    ///< graph has negative cycle.
+	NoPath,           ///< end vertice unreachable from begin vertice.
+};
+
+const int GRAPH_STATUS_NUM = 6;  ///< number of graph status.
+
+const char *graphStatusName(GraphStatus status);
+
+
+/// \brief Counters of graph queries by status.
+struct QueryMetrics
+{
+	size_t queryNum{0};   ///< number of queries.
+	size_t failedNum{0};  ///< number of failed queries.
+	array<size_t, GRAPH_STATUS_NUM> statusNum{};  ///< failed queries by status.
+};
+
+
+/// \brief Level of query logging.
+enum class LogLevel
+{
+	Off,    ///< nothing logged.
+	Error,  ///< failed queries logged.
+	Debug,  ///< all queries logged.
+};
+
+
 /// \brief To search shortest path between two vertices in directed graph.
 ///
+/// \details Graph is stored in CSR format and may be edited in place. Queries
+///        return `false` on failure, with the reason in `getLastStatus()`.
+///
 /// \attention Dijkstra algorithm has the ability to search all pathes once from
-///        source vertice to all others. Meanwhile, Dijkstra algorithm doesn't
-///        support negative edge value(weight).
+///        source vertice to all others.
 class DirectedGraphHandler
 {
 public:
 	using GraphMatrix = vector<vector<double>>;  ///< graph adjacent matrix.
 	using Graph = vector<tuple<string, string, double>>;  ///< graph edges.
 
+	DirectedGraphHandler() = default;
+	DirectedGraphHandler(const DirectedGraphHandler &other);
+	DirectedGraphHandler(DirectedGraphHandler &&other) noexcept;
+	DirectedGraphHandler &operator=(const DirectedGraphHandler &other);
+	DirectedGraphHandler &operator=(DirectedGraphHandler &&other) noexcept;
+
+	/// graph is set even if not weakly connected, which returns `false`.
 	bool setGraph(const Graph &graph);
+	bool loadGraph(const string &file, int threadNum = 0);
+	bool saveSnapshot(const string &file) const;
+	bool loadSnapshot(const string &file);
 	bool runDijkstraAlgo(const string &begVertice, const string &endVertice);
+	/// batch queries are grouped by begin vertice, answered from one shortest
+	/// path tree per source; recent trees are cached until graph changes.
 	bool runDijkstraAlgo(const vector<array<string, 2>> &vertices);
+	bool runDijkstraAlgo(const string &begVertice);
+	bool runDijkstraAlgo(const vector<array<string, 2>> &vertices, int threadNum);
+	/// lengths between all pairs of vertices by blocked Floyd-Warshall algorithm,
+	/// row by row in order of vertices index; _DBL_MAX if unreachable.
+	bool runFloydWarshallAlgo(GraphMatrix &matrix, int threadNum = 0);
+	bool runFloydWarshallAlgo(VecDbl &matrix, int threadNum = 0);
+	/// top k loopless pathes by Yen's algorithm.
+	bool runYenAlgo(const string &begVertice, const string &endVertice, int k);
+
+	/// graph is edited in place, dropping only cached trees it may change;
+	/// new vertices are indexed in order of adding.
+	bool addVertice(const string &verId);
+	bool addEdge(const string &begVertice, const string &endVertice, double value);
+	bool removeEdge(const string &begVertice, const string &endVertice);
+	bool setEdgeValue(const string &begVertice, const string &endVertice, double value);
+
+	void setPathTreeCapacity(size_t capacity);
+	/// single pair queries not answered by cached trees run in this mode.
+	void setSearchMode(SearchMode mode);
+	void setHeuristic(const ShortestPathEngine::Heuristic &heuristic);
+
+	SearchStats getSearchStats() const;
+	void resetSearchStats();
+
+	/// queries and graph edits never print unless logged by level; queries
+	/// are counted in metrics.
+	void setLogLevel(LogLevel level);
+	GraphStatus getLastStatus() const;
+	const QueryMetrics &getQueryMetrics() const;
+	void resetQueryMetrics();
+
+	/// hierarchy is built, saved or loaded explicitly, dropped once graph changes.
+	bool buildContractionHierarchy();
+	bool saveContractionHierarchy(const string &file) const;
+	bool loadContractionHierarchy(const string &file);
+
+	/// engine sharing current graph snapshot, for concurrent queries.
+	ShortestPathEngine getQueryEngine() const;
+	int getVerticeIndex(const string &verId) const;
 
 	void getGraphMatrix(GraphMatrix &matrix) const;
 	void getPathes(vector<VecStr> &pathes) const;
+	const PathStore &getPathResults() const;
+	void getWeaklyConnectedComponents(vector<VecStr> &components) const;
+	void getStronglyConnectedComponents(vector<VecStr> &components) const;
 
 	void displayGraphMatrix() const;
 	void displayPathes() const;
 
 private:
-	string getVerticeId(int ind) const;
-	bool isGraphConnected();
+	const string &getVerticeId(int ind) const;
+	void resetVertices(VecStr &&verIds);
+	void resetGraph(shared_ptr<CsrGraph> graph, shared_ptr<CsrGraph> reverseGraph);
+	bool isGraphConnected() const;
 	void clearCurrStatus();
+	void clearPathes();
+	void groupVertices(const VecInt &components, int count,
+	                   vector<VecStr> &verticeGroups) const;
 
-	bool checkDijkstraAlgoValid(const string &begVertice, const string &endVertice);
-	void initDijkstraAlgoStatus();
-	void DijkstraAlgo();
-	VecInt parsePath();
+	GraphStatus checkGraphValid();
+	GraphStatus checkPairValid(const string &begVertice, const string &endVertice);
+	bool passQuery(const string &begVertice, const string &endVertice);
+	bool failQuery(GraphStatus status, const string &begVertice, const string &endVertice);
+	void logQuery(const string &begVertice, const string &endVertice) const;
+	const ShortestPathTree &searchPathTree(int begVerticeInd);
+	void clearPathTrees();
+
+	int internVertice(const string &verId);
+	void detachGraph();
+	void updatePathTrees(int begVerticeInd, int endVerticeInd, double oldValue, double newValue);
 
 private:
 	int                _currBegVerticeInd;  // current begin vertice index.
 	int                _currEndVerticeInd;  // current end vertice index.
-	bool               _isMultiSets{false}; // if inputting many vertices once for Dijkstra.
-	vector<VecInt>     _pathRoutes;         // shortest pathes consisting of vertices index.
+	PathStore          _pathes;             // shortest pathes consisting of vertices index.
+	PathStore          _groupedPathes;      // pathes in order of begin vertice, scratch.
+	VecInt             _route;              // route of single pair query, scratch.
 
-	VecDbl             _dist;               // path length from source vertice to all others.
-	VecBool            _book;               // vertices with known shortest path.
-	VecInt             _path;               // previous vertice in shortest path of each vertices.
-	GraphMatrix        _matrix;             // graph matrix recoding path length.
+	DijkstraWorkspace  _workspace;          // scratch state reused by queries.
+	DijkstraWorkspace  _backWorkspace;      // scratch state of backward search.
+	size_t             _pathTreeCapacity{16};  // max number of cached trees.
+	std::deque<int>    _pathTreeOrder;      // cached trees' sources, oldest first.
+	unordered_map<int, ShortestPathTree> _pathTrees;  // cached trees by source.
+	shared_ptr<CsrGraph> _graph{std::make_shared<CsrGraph>()};  // graph edges in CSR format.
+	shared_ptr<CsrGraph> _reverseGraph{std::make_shared<CsrGraph>()};  // reversed edges.
+	ShortestPathEngine _engine;             // queries over current graph.
+	VecStr             _verIds;             // interned vertices, indexed by its index.
 	MapStrInt          _verIdToInd;         // map of vertices and its index.
+
+	GraphStatus        _lastStatus{GraphStatus::Ok};  // status of last query.
+	QueryMetrics       _metrics;            // counters of queries.
+	LogLevel           _logLevel{LogLevel::Off};  // level of query logging.
 };
 
 }  // end of namespace ccb.
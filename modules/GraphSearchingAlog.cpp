@@ -5,306 +5,2233 @@
 ** ******************************************************************************/
 
 #include "common/CommConsts.hpp"
+#include "common/CommThreads.hpp"
 #include "GraphSearchingAlgo.hpp"
-#include <set>
+#include "GraphContractionHierarchy.hpp"
+#include "GraphFileIO.hpp"
+#include "GraphAllPairs.hpp"
+#include "GraphKShortestPath.hpp"
 #include <iomanip>
 #include <functional>
+#include <cmath>
+#include <numeric>
+#include <atomic>
+#include <mutex>
 
 
 namespace ccb
 {
 
+namespace
+{
+
+/// integral values well below 2^53 allows radix heap.
+bool isIntegral(double weight)
+{
+	return weight >= 0.0 && weight < 1.0e9 && weight == std::floor(weight);
+}
+
+}  // end of anonymous namespace.
+
+/////////////////////////////////////////////////////////////////////////////////
+// class CsrGraph.
+/////////////////////////////////////////////////////////////////////////////////
+
+CsrGraph::CsrGraph(const CsrGraph &other)
+{
+	*this = other;
+}
+
+CsrGraph::CsrGraph(CsrGraph &&other) noexcept
+{
+	*this = std::move(other);
+}
+
+CsrGraph &CsrGraph::operator=(const CsrGraph &other)
+{
+	if (this != &other)
+	{
+		_begins = other._begins;
+		_ends = other._ends;
+		_limits = other._limits;
+		_targets = other._targets;
+		_weights = other._weights;
+		_verticeNum = other._verticeNum;
+		_edgeNum = other._edgeNum;
+		_idleSlots = other._idleSlots;
+
+		_keepalive = other._keepalive;
+		_beginData = other._beginData;
+		_endData = other._endData;
+		_targetData = other._targetData;
+		_weightData = other._weightData;
+		refreshViews();
+	}
+	return *this;
+}
+
+CsrGraph &CsrGraph::operator=(CsrGraph &&other) noexcept
+{
+	if (this != &other)
+	{
+		_begins = std::move(other._begins);
+		_ends = std::move(other._ends);
+		_limits = std::move(other._limits);
+		_targets = std::move(other._targets);
+		_weights = std::move(other._weights);
+		_verticeNum = other._verticeNum;
+		_edgeNum = other._edgeNum;
+		_idleSlots = other._idleSlots;
+
+		_keepalive = std::move(other._keepalive);
+		_beginData = other._beginData;
+		_endData = other._endData;
+		_targetData = other._targetData;
+		_weightData = other._weightData;
+		refreshViews();
+		other.clear();
+	}
+	return *this;
+}
+
+void CsrGraph::build(int verticeNum, const vector<CsrEdge> &edges)
+{
+	clear();
+	_begins.assign(verticeNum + 1, 0);
+	_ends.assign(verticeNum, 0);
+	_targets.resize(edges.size());
+	_weights.resize(edges.size());
+
+	// scatter edges into rows by counting sort, in input order.
+	for (const auto &edge : edges)
+	{
+		_begins[edge.beg + 1]++;
+	}
+	for (int i = 0; i < verticeNum; ++i)
+	{
+		_begins[i + 1] += _begins[i];
+		_ends[i] = _begins[i];
+	}
+	for (const auto &edge : edges)
+	{
+		int pos = _ends[edge.beg]++;
+		_targets[pos] = edge.end;
+		_weights[pos] = edge.weight;
+	}
+
+	// sort each row by end vertice, keeping input order of duplicated edges so
+	// that the last one overrides others; rows are packed without idle slots.
+	vector<std::pair<int, double>> row;
+	int offset = 0;
+	for (int i = 0; i < verticeNum; ++i)
+	{
+		row.clear();
+		for (int e = _begins[i]; e < _ends[i]; ++e)
+		{
+			row.emplace_back(_targets[e], _weights[e]);
+		}
+		std::stable_sort(row.begin(), row.end(), [](const auto & lhs, const auto & rhs)
+		{
+			return lhs.first < rhs.first;
+		});
+
+		_begins[i] = offset;
+		for (size_t k = 0; k < row.size(); ++k)
+		{
+			if (k + 1 < row.size() && row[k + 1].first == row[k].first)
+			{
+				continue;  // overridden by following duplicated edge.
+			}
+			_targets[offset] = row[k].first;
+			_weights[offset] = row[k].second;
+			offset++;
+		}
+		_ends[i] = offset;
+	}
+
+	_begins.resize(verticeNum);
+	_targets.resize(offset);
+	_weights.resize(offset);
+	_limits = _ends;
+	_verticeNum = verticeNum;
+	_edgeNum = offset;
+	refreshViews();
+}
+
+void CsrGraph::attach(shared_ptr<const void> keepalive, int verticeNum, int edgeNum,
+                      const int *offsets, const int *targets, const double *weights)
+{
+	// rows are packed, so that ends are offsets of next vertices.
+	clear();
+	_keepalive = std::move(keepalive);
+	_verticeNum = verticeNum;
+	_edgeNum = edgeNum;
+	_beginData = offsets;
+	_endData = offsets + 1;
+	_targetData = targets;
+	_weightData = weights;
+}
+
+void CsrGraph::clear()
+{
+	_begins.clear();
+	_ends.clear();
+	_limits.clear();
+	_targets.clear();
+	_weights.clear();
+	_verticeNum = 0;
+	_edgeNum = 0;
+	_idleSlots = 0;
+	_keepalive.reset();
+	refreshViews();
+}
+
+void CsrGraph::detach()
+{
+	if (!isAttached())
+	{
+		return;
+	}
+
+	// copy attached arrays before modification.
+	_begins.assign(_beginData, _beginData + _verticeNum);
+	_ends.assign(_endData, _endData + _verticeNum);
+	_limits = _ends;
+	_targets.assign(_targetData, _targetData + _edgeNum);
+	_weights.assign(_weightData, _weightData + _edgeNum);
+	_idleSlots = 0;
+	_keepalive.reset();
+	refreshViews();
+}
+
+void CsrGraph::refreshViews()
+{
+	if (!isAttached())
+	{
+		_beginData = _begins.data();
+		_endData = _ends.data();
+		_targetData = _targets.data();
+		_weightData = _weights.data();
+	}
+}
+
+int CsrGraph::findEdge(int beg, int end) const
+{
+	const int *first = _targetData + edgeBegin(beg);
+	const int *last = _targetData + edgeEnd(beg);
+	const int *iter = std::lower_bound(first, last, end);
+
+	return (iter != last && *iter == end) ? static_cast<int>(iter - _targetData) : -1;
+}
+
+double CsrGraph::findWeight(int beg, int end) const
+{
+	int edge = findEdge(beg, end);
+	return (edge >= 0) ? _weightData[edge] : _DBL_MAX;
+}
+
+int CsrGraph::addVertice()
+{
+	detach();
+	int offset = static_cast<int>(_targets.size());
+	_begins.emplace_back(offset);
+	_ends.emplace_back(offset);
+	_limits.emplace_back(offset);
+	_verticeNum++;
+	refreshViews();
+
+	return _verticeNum - 1;
+}
+
+bool CsrGraph::insertEdge(int beg, int end, double weight)
+{
+	detach();
+	auto first = _targets.begin() + edgeBegin(beg);
+	auto last = _targets.begin() + edgeEnd(beg);
+	int pos = static_cast<int>(std::lower_bound(first, last, end) - _targets.begin());
+	if (pos < _ends[beg] && _targets[pos] == end)
+	{
+		return false;  // edge exists.
+	}
+
+	if (_ends[beg] == _limits[beg])
+	{
+		int degree = _ends[beg] - _begins[beg];
+		pos += -_begins[beg];
+		moveRow(beg, (std::max)(4, 2 * degree));
+		pos += _begins[beg];
+	}
+
+	// shift following edges to keep row sorted.
+	for (int e = _ends[beg]; e > pos; --e)
+	{
+		_targets[e] = _targets[e - 1];
+		_weights[e] = _weights[e - 1];
+	}
+	_targets[pos] = end;
+	_weights[pos] = weight;
+	_ends[beg]++;
+	_edgeNum++;
+	refreshViews();
+
+	return true;
+}
+
+bool CsrGraph::eraseEdge(int beg, int end)
+{
+	int pos = findEdge(beg, end);
+	if (pos < 0)
+	{
+		return false;
+	}
+	detach();
+
+	for (int e = pos + 1; e < _ends[beg]; ++e)
+	{
+		_targets[e - 1] = _targets[e];
+		_weights[e - 1] = _weights[e];
+	}
+	_ends[beg]--;
+	_edgeNum--;
+
+	return true;
+}
+
+bool CsrGraph::setWeight(int beg, int end, double weight)
+{
+	int pos = findEdge(beg, end);
+	if (pos < 0)
+	{
+		return false;
+	}
+
+	detach();
+	_weights[pos] = weight;
+	return true;
+}
+
+void CsrGraph::moveRow(int ver, int capacity)
+{
+	// copy row to the tail and leave its old slots idle.
+	int offset = static_cast<int>(_targets.size());
+	_targets.resize(offset + capacity, -1);
+	_weights.resize(offset + capacity, 0.0);
+	std::copy(_targets.begin() + _begins[ver], _targets.begin() + _ends[ver],
+	          _targets.begin() + offset);
+	std::copy(_weights.begin() + _begins[ver], _weights.begin() + _ends[ver],
+	          _weights.begin() + offset);
+
+	_idleSlots += _limits[ver] - _begins[ver];
+	_ends[ver] = offset + (_ends[ver] - _begins[ver]);
+	_begins[ver] = offset;
+	_limits[ver] = offset + capacity;
+
+	if (_idleSlots > static_cast<int>(_targets.size()) / 2)
+	{
+		compact();
+	}
+}
+
+void CsrGraph::compact()
+{
+	// repack rows in order of vertices, keeping their capacity.
+	VecInt targets;
+	VecDbl weights;
+	targets.reserve(_targets.size() - _idleSlots);
+	weights.reserve(_targets.size() - _idleSlots);
+	for (int i = 0; i < verticeNum(); ++i)
+	{
+		int offset = static_cast<int>(targets.size());
+		targets.insert(targets.end(), _targets.begin() + _begins[i], _targets.begin() + _limits[i]);
+		weights.insert(weights.end(), _weights.begin() + _begins[i], _weights.begin() + _limits[i]);
+
+		_ends[i] = offset + (_ends[i] - _begins[i]);
+		_limits[i] = offset + (_limits[i] - _begins[i]);
+		_begins[i] = offset;
+	}
+
+	_targets.swap(targets);
+	_weights.swap(weights);
+	_idleSlots = 0;
+}
+
+CsrGraph CsrGraph::reversed() const
+{
+	vector<CsrEdge> edges;
+	edges.reserve(_edgeNum);
+	for (int i = 0; i < verticeNum(); ++i)
+	{
+		for (int e = edgeBegin(i); e < edgeEnd(i); ++e)
+		{
+			edges.push_back({target(e), i, weight(e)});
+		}
+	}
+
+	CsrGraph graph;
+	graph.build(verticeNum(), edges);
+	return graph;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// class IndexedMinHeap.
+/////////////////////////////////////////////////////////////////////////////////
+
+void IndexedMinHeap::resize(int capacity)
+{
+	if (static_cast<int>(_pos.size()) != capacity)
+	{
+		_heap.clear();
+		_pos.assign(capacity, -1);
+	}
+}
+
+void IndexedMinHeap::clear()
+{
+	for (const auto &elem : _heap)
+	{
+		_pos[elem.second] = -1;
+	}
+	_heap.clear();
+}
+
+void IndexedMinHeap::push(int ver, double key)
+{
+	int pos = _pos[ver];
+	if (pos < 0)
+	{
+		_heap.emplace_back(key, ver);
+		_pos[ver] = static_cast<int>(_heap.size()) - 1;
+		siftUp(_pos[ver]);
+	}
+	else if (key < _heap[pos].first)
+	{
+		_heap[pos].first = key;  // decrease key.
+		siftUp(pos);
+	}
+}
+
+int IndexedMinHeap::pop()
+{
+	int ver = _heap.front().second;
+	_pos[ver] = -1;
+
+	if (_heap.size() > 1)
+	{
+		_heap.front() = _heap.back();
+		_pos[_heap.front().second] = 0;
+		_heap.pop_back();
+		siftDown(0);
+	}
+	else
+	{
+		_heap.pop_back();
+	}
+
+	return ver;
+}
+
+void IndexedMinHeap::siftUp(int pos)
+{
+	auto elem = _heap[pos];
+	while (pos > 0)
+	{
+		int parent = (pos - 1) / 2;
+		if (!(elem.first < _heap[parent].first))
+		{
+			break;
+		}
+
+		_heap[pos] = _heap[parent];
+		_pos[_heap[pos].second] = pos;
+		pos = parent;
+	}
+
+	_heap[pos] = elem;
+	_pos[elem.second] = pos;
+}
+
+void IndexedMinHeap::siftDown(int pos)
+{
+	auto elem = _heap[pos];
+	int size = static_cast<int>(_heap.size());
+	while (2 * pos + 1 < size)
+	{
+		int child = 2 * pos + 1;
+		if (child + 1 < size && _heap[child + 1].first < _heap[child].first)
+		{
+			child++;
+		}
+		if (!(_heap[child].first < elem.first))
+		{
+			break;
+		}
+
+		_heap[pos] = _heap[child];
+		_pos[_heap[pos].second] = pos;
+		pos = child;
+	}
+
+	_heap[pos] = elem;
+	_pos[elem.second] = pos;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// class RadixHeap.
+/////////////////////////////////////////////////////////////////////////////////
+
+void RadixHeap::reset()
+{
+	for (auto &bucket : _buckets)
+	{
+		bucket.clear();
+	}
+	_last = 0;
+	_size = 0;
+}
+
+int RadixHeap::bucketIndex(uint64_t key, uint64_t last)
+{
+	int ind = 0;
+	for (uint64_t diff = key ^ last; diff > 0; diff >>= 1)
+	{
+		ind++;
+	}
+
+	return ind;
+}
+
+void RadixHeap::push(int ver, double key)
+{
+	uint64_t intKey = static_cast<uint64_t>(key);
+	_buckets[bucketIndex(intKey, _last)].emplace_back(intKey, ver);
+	_size++;
+}
+
+int RadixHeap::pop()
+{
+	// refill bucket 0 from the first non-empty bucket by redistributing it.
+	if (_buckets[0].empty())
+	{
+		int ind = 1;
+		while (_buckets[ind].empty())
+		{
+			ind++;
+		}
+
+		auto iter = std::min_element(_buckets[ind].begin(), _buckets[ind].end());
+		_last = iter->first;
+		for (const auto &elem : _buckets[ind])
+		{
+			_buckets[bucketIndex(elem.first, _last)].emplace_back(elem);
+		}
+		_buckets[ind].clear();
+	}
+
+	int ver = _buckets[0].back().second;
+	_buckets[0].pop_back();
+	_size--;
+
+	return ver;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// class GraphConnectivity.
+/////////////////////////////////////////////////////////////////////////////////
+
+int GraphConnectivity::weakComponents(const CsrGraph &graph, VecInt &components)
+{
+	// merge end vertices of each edge ignoring its direction.
+	int size = graph.verticeNum();
+	VecInt parents(size);
+	VecInt sizes(size, 1);
+	for (int i = 0; i < size; ++i)
+	{
+		parents[i] = i;
+	}
+
+	for (int i = 0; i < size; ++i)
+	{
+		for (int e = graph.edgeBegin(i); e < graph.edgeEnd(i); ++e)
+		{
+			int lhs = findRoot(parents, i);
+			int rhs = findRoot(parents, graph.target(e));
+			if (lhs == rhs)
+			{
+				continue;
+			}
+
+			// union by size.
+			if (sizes[lhs] < sizes[rhs])
+			{
+				std::swap(lhs, rhs);
+			}
+			parents[rhs] = lhs;
+			sizes[lhs] += sizes[rhs];
+		}
+	}
+
+	// label components in order of their first vertice.
+	int count = 0;
+	components.assign(size, -1);
+	for (int i = 0; i < size; ++i)
+	{
+		int root = findRoot(parents, i);
+		if (components[root] < 0)
+		{
+			components[root] = count++;
+		}
+		components[i] = components[root];
+	}
+
+	return count;
+}
+
+int GraphConnectivity::strongComponents(const CsrGraph &graph, VecInt &components)
+{
+	int size = graph.verticeNum();
+	int count = 0;
+	int order = 0;
+	VecInt orders(size, -1);    // visiting order of each vertice.
+	VecInt lowLinks(size, 0);   // lowest order reachable in DFS subtree.
+	VecBool onStack(size, false);
+	VecInt stack;               // vertices of unfinished components.
+	vector<std::pair<int, int>> callStack;  // pairs of vertice and next edge.
+	components.assign(size, -1);
+
+	for (int root = 0; root < size; ++root)
+	{
+		if (orders[root] >= 0)
+		{
+			continue;
+		}
+
+		callStack.emplace_back(root, graph.edgeBegin(root));
+		orders[root] = lowLinks[root] = order++;
+		stack.emplace_back(root);
+		onStack[root] = true;
+
+		while (!callStack.empty())
+		{
+			int ver = callStack.back().first;
+			int &edge = callStack.back().second;
+
+			// descend into next unvisited successor.
+			if (edge < graph.edgeEnd(ver))
+			{
+				int next = graph.target(edge++);
+				if (orders[next] < 0)
+				{
+					orders[next] = lowLinks[next] = order++;
+					stack.emplace_back(next);
+					onStack[next] = true;
+					callStack.emplace_back(next, graph.edgeBegin(next));
+				}
+				else if (onStack[next])
+				{
+					lowLinks[ver] = (std::min)(lowLinks[ver], orders[next]);
+				}
+				continue;
+			}
+
+			// all successors done: pop component rooted at this vertice.
+			if (lowLinks[ver] == orders[ver])
+			{
+				int member = -1;
+				while (member != ver)
+				{
+					member = stack.back();
+					stack.pop_back();
+					onStack[member] = false;
+					components[member] = count;
+				}
+				count++;
+			}
+
+			callStack.pop_back();
+			if (!callStack.empty())
+			{
+				int parent = callStack.back().first;
+				lowLinks[parent] = (std::min)(lowLinks[parent], lowLinks[ver]);
+			}
+		}
+	}
+
+	return count;
+}
+
+int GraphConnectivity::findRoot(VecInt &parents, int ver)
+{
+	// path halving.
+	while (parents[ver] != ver)
+	{
+		parents[ver] = parents[parents[ver]];
+		ver = parents[ver];
+	}
+
+	return ver;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// struct DijkstraWorkspace.
+/////////////////////////////////////////////////////////////////////////////////
+
+void DijkstraWorkspace::prepare(int verticeNum, int begVerticeInd)
+{
+	if (static_cast<int>(dist.size()) != verticeNum)
+	{
+		dist.assign(verticeNum, _DBL_MAX);
+		book.assign(verticeNum, false);
+		path.assign(verticeNum, -1);
+		hops.assign(verticeNum, 0);
+		touched.clear();
+	}
+
+	// reset vertices touched by last query only.
+	for (int ver : touched)
+	{
+		dist[ver] = _DBL_MAX;
+		book[ver] = false;
+		path[ver] = -1;
+		hops[ver] = 0;
+	}
+	touched.clear();
+	queue.clear();
+
+	heap.resize(verticeNum);
+	heap.clear();
+	radixHeap.reset();
+
+	touch(begVerticeInd, 0.0, begVerticeInd);
+}
+
+void DijkstraWorkspace::touch(int ver, double verDist, int preVer)
+{
+	if (path[ver] < 0)
+	{
+		touched.emplace_back(ver);
+	}
+	dist[ver] = verDist;
+	path[ver] = preVer;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// class PathView and PathStore.
+/////////////////////////////////////////////////////////////////////////////////
+
+PathView::PathView(const PathStore &store, size_t ind)
+	: _store(&store),
+	  _first(store._vertices.data() + store._offsets[ind]),
+	  _last(store._vertices.data() + store._offsets[ind + 1]),
+	  _cost(store._costs[ind])
+{
+}
+
+std::string_view PathView::name(size_t pos) const
+{
+	return _store->name(_first[pos]);
+}
+
+void PathStore::clear()
+{
+	_offsets.resize(1);
+	_vertices.clear();
+	_costs.clear();
+}
+
+void PathStore::reserve(size_t pathNum, size_t verticeNum)
+{
+	_offsets.reserve(pathNum + 1);
+	_vertices.reserve(verticeNum);
+	_costs.reserve(pathNum);
+}
+
+void PathStore::setNames(const VecStr *names)
+{
+	_names = names;
+}
+
+void PathStore::append(const int *first, const int *last, double cost)
+{
+	_vertices.insert(_vertices.end(), first, last);
+	_offsets.emplace_back(static_cast<int>(_vertices.size()));
+	_costs.emplace_back(cost);
+}
+
+void PathStore::append(const PathView &path)
+{
+	append(path.begin(), path.end(), path.cost());
+}
+
+void PathStore::appendFromTree(const VecInt &path, int begVerticeInd, int endVerticeInd,
+                               double cost)
+{
+	// walk back to begin vertice, then reverse in place.
+	size_t first = _vertices.size();
+	_vertices.emplace_back(endVerticeInd);
+	for (int ver = endVerticeInd; ver != begVerticeInd; )
+	{
+		ver = path[ver];
+		_vertices.emplace_back(ver);
+	}
+	std::reverse(_vertices.begin() + first, _vertices.end());
+
+	_offsets.emplace_back(static_cast<int>(_vertices.size()));
+	_costs.emplace_back(cost);
+}
+
+std::string_view PathStore::name(int ver) const
+{
+	if (!_names || ver < 0 || ver >= static_cast<int>(_names->size()))
+	{
+		return std::string_view();
+	}
+	return (*_names)[ver];
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// class ShortestPathEngine.
+/////////////////////////////////////////////////////////////////////////////////
+
+ShortestPathEngine::ShortestPathEngine()
+	: _graph(std::make_shared<CsrGraph>()), _reverseGraph(std::make_shared<CsrGraph>())
+{
+}
+
+ShortestPathEngine::ShortestPathEngine(shared_ptr<const CsrGraph> graph,
+                                       shared_ptr<const CsrGraph> reverseGraph)
+{
+	setGraph(std::move(graph), std::move(reverseGraph));
+}
+
+ShortestPathEngine ShortestPathEngine::reversed() const
+{
+	// to search pathes to a vertice from all others.
+	return ShortestPathEngine(_reverseGraph, _graph);
+}
+
+void ShortestPathEngine::setGraph(shared_ptr<const CsrGraph> graph,
+                                  shared_ptr<const CsrGraph> reverseGraph)
+{
+	_graph = std::move(graph);
+	_reverseGraph = std::move(reverseGraph);
+	_hierarchy.reset();  // hierarchy of old graph.
+
+	// edge values are validated once here rather than on each query.
+	_isIntegral = true;
+	_negativeEdgeNum = 0;
+	for (int i = 0; i < _graph->verticeNum(); ++i)
+	{
+		for (int e = _graph->edgeBegin(i); e < _graph->edgeEnd(i); ++e)
+		{
+			_isIntegral = _isIntegral && isIntegral(_graph->weight(e));
+			_negativeEdgeNum += (_graph->weight(e) < 0.0) ? 1 : 0;
+		}
+	}
+
+	_hasNegativeCycle = false;
+	_isReweighted = false;
+	if (_negativeEdgeNum > 0)
+	{
+		reweight();
+	}
+}
+
+void ShortestPathEngine::notifyGraphChanged()
+{
+	// graph snapshot was modified in place, e.g. a vertice added.
+	_hierarchy.reset();
+}
+
+void ShortestPathEngine::notifyEdgeChanged(int begVerticeInd, int endVerticeInd,
+        double oldWeight, double newWeight)
+{
+	// graph snapshot was modified in place, INF for absent edge; integral flag
+	// stays conservative until next `setGraph()`.
+	_isIntegral = _isIntegral && (newWeight == _DBL_MAX || isIntegral(newWeight));
+	_negativeEdgeNum += ((newWeight < 0.0) ? 1 : 0) - ((oldWeight < 0.0) ? 1 : 0);
+	_hierarchy.reset();
+
+	// potentials stay valid unless reduced value of the new edge is negative,
+	// while a negative cycle may be broken by any change; broken potentials
+	// are recomputed here, so that queries never reweight.
+	if (_hasNegativeCycle || (_isReweighted && newWeight < _DBL_MAX
+	                          && newWeight + potential(begVerticeInd) - potential(endVerticeInd) < 0.0))
+	{
+		_hasNegativeCycle = false;
+		_isReweighted = false;
+	}
+	if (_negativeEdgeNum > 0 && !_isReweighted)
+	{
+		reweight();
+	}
+}
+
+bool ShortestPathEngine::reweight()
+{
+	// Bellman-Ford algorithm(SPFA) from a virtual source linked to all vertices,
+	// starting from old potentials if any, which converges in a few passes
+	// after small updates.
+	int size = _graph->verticeNum();
+	VecDbl potentials(size, 0.0);
+	if (_potentials)
+	{
+		for (int i = 0; i < size; ++i)
+		{
+			potentials[i] = potential(i);
+		}
+	}
+
+	VecInt hops(size, 0);
+	VecBool isQueued(size, true);
+	std::deque<int> queue(size);
+	std::iota(queue.begin(), queue.end(), 0);
+	while (!queue.empty())
+	{
+		int ver = queue.front();
+		queue.pop_front();
+		isQueued[ver] = false;
+
+		for (int e = _graph->edgeBegin(ver); e < _graph->edgeEnd(ver); ++e)
+		{
+			int j = _graph->target(e);
+			double currPotential = potentials[ver] + _graph->weight(e);
+			if (currPotential < potentials[j])
+			{
+				potentials[j] = currPotential;
+				hops[j] = hops[ver] + 1;
+				if (hops[j] >= size)
+				{
+					// a path of `size` edges repeats a vertice on negative cycle,
+					// which queries report by status.
+					_potentials.reset();
+					_isReweighted = false;
+					_hasNegativeCycle = true;
+					return false;
+				}
+				if (!isQueued[j])
+				{
+					isQueued[j] = true;
+					queue.emplace_back(j);
+				}
+			}
+		}
+	}
+
+	_potentials = std::make_shared<const VecDbl>(std::move(potentials));
+	_isReweighted = true;
+	_hasNegativeCycle = false;
+	return true;
+}
+
+void ShortestPathEngine::setSearchMode(SearchMode mode)
+{
+	_mode = mode;
+}
+
+void ShortestPathEngine::setHeuristic(const Heuristic &heuristic)
+{
+	_heuristic = heuristic;
+}
+
+void ShortestPathEngine::setHierarchy(shared_ptr<const ContractionHierarchy> hierarchy)
+{
+	_hierarchy = std::move(hierarchy);
+}
+
+bool ShortestPathEngine::searchPath(int begVerticeInd, int endVerticeInd,
+                                    DijkstraWorkspace &workspace,
+                                    DijkstraWorkspace &backWorkspace, VecInt &route) const
+{
+	route.clear();
+
+	if (_mode == SearchMode::ContractionHierarchy && _hierarchy)
+	{
+		return _hierarchy->searchPath(begVerticeInd, endVerticeInd, workspace, backWorkspace,
+		                              route);
+	}
+
+	// reduced edge values are for forward search only.
+	if (_mode == SearchMode::Bidirectional && _negativeEdgeNum == 0)
+	{
+		int meetVerInd = bidirectionalAlgo(begVerticeInd, endVerticeInd, workspace, backWorkspace);
+		if (meetVerInd < 0)
+		{
+			return false;
+		}
+
+		// join forward path to meeting vertice and backward path from it.
+		route = parsePath(workspace.path, begVerticeInd, meetVerInd);
+		for (int ver = meetVerInd; ver != endVerticeInd; )
+		{
+			ver = backWorkspace.path[ver];
+			route.emplace_back(ver);
+		}
+		return true;
+	}
+
+	(_mode == SearchMode::AStar && _negativeEdgeNum == 0)
+	? AStarAlgo(begVerticeInd, endVerticeInd, workspace)
+	: DijkstraAlgo(begVerticeInd, endVerticeInd, workspace);
+
+	if (workspace.path[endVerticeInd] < 0)
+	{
+		return false;
+	}
+
+	route = parsePath(workspace.path, begVerticeInd, endVerticeInd);
+	return true;
+}
+
+vector<VecInt> ShortestPathEngine::searchPathes(const vector<array<int, 2>> &vertices,
+        int threadNum, SearchStats *stats) const
+{
+	PathStore pathes;
+	searchPathes(vertices, pathes, threadNum, stats);
+
+	vector<VecInt> routes(pathes.size());
+	for (size_t i = 0; i < pathes.size(); ++i)
+	{
+		routes[i].assign(pathes[i].begin(), pathes[i].end());
+	}
+	return routes;
+}
+
+void ShortestPathEngine::searchPathes(const vector<array<int, 2>> &vertices,
+                                      PathStore &pathes, int threadNum,
+                                      SearchStats *stats) const
+{
+	// no shortest path at all on negative cycle, as handler queries fail.
+	if (_hasNegativeCycle)
+	{
+		pathes.clear();
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			pathes.append(nullptr, nullptr, _DBL_MAX);
+		}
+		return;
+	}
+
+	// group requests by begin vertice.
+	VecInt sources;
+	unordered_map<int, VecInt> groups;
+	int size = _graph->verticeNum();
+	for (int i = 0; i < static_cast<int>(vertices.size()); ++i)
+	{
+		int begInd = vertices[i][0];
+		if (begInd < 0 || begInd >= size || vertices[i][1] < 0 || vertices[i][1] >= size)
+		{
+			continue;  // invalid vertices have no path.
+		}
+
+		if (groups.count(begInd) < 1)
+		{
+			sources.emplace_back(begInd);
+		}
+		groups[begInd].emplace_back(i);
+	}
+
+	threadNum = (std::max)(1, (std::min)(threadsOf(threadNum), static_cast<int>(sources.size())));
+
+	// each worker takes next begin vertice, searches in its own workspace and
+	// appends pathes to its own store; slots locate pathes of requests.
+	vector<PathStore> stores(threadNum);
+	vector<array<int, 2>> slots(vertices.size(), array<int, 2> {-1, -1});
+	std::atomic<size_t> next{0};
+	std::mutex statsMutex;
+	auto worker = [&](int id)
+	{
+		DijkstraWorkspace workspace, backWorkspace;
+		PathStore &store = stores[id];
+		VecInt route;
+		for (size_t ind = next++; ind < sources.size(); ind = next++)
+		{
+			int begInd = sources[ind];
+			const VecInt &group = groups.at(begInd);
+			if (group.size() == 1)
+			{
+				if (searchPath(begInd, vertices[group[0]][1], workspace, backWorkspace, route))
+				{
+					slots[group[0]] = {id, static_cast<int>(store.size())};
+					store.append(route.data(), route.data() + route.size(), pathLength(route));
+				}
+				continue;
+			}
+
+			// search all vertices if many requests share begin vertice.
+			DijkstraAlgo(begInd, -1, workspace);
+			for (int i : group)
+			{
+				int endInd = vertices[i][1];
+				if (workspace.path[endInd] >= 0)
+				{
+					slots[i] = {id, static_cast<int>(store.size())};
+					store.appendFromTree(workspace.path, begInd, endInd, workspace.dist[endInd]);
+				}
+			}
+		}
+
+		if (stats)
+		{
+			std::lock_guard<std::mutex> lock(statsMutex);
+			stats->queryNum += workspace.stats.queryNum;
+			stats->settledVertices += workspace.stats.settledVertices
+			                          + backWorkspace.stats.settledVertices;
+			stats->relaxedEdges += workspace.stats.relaxedEdges + backWorkspace.stats.relaxedEdges;
+		}
+	};
+
+	parallelFor(threadNum, threadNum, worker);
+
+	// pathes in input order, empty with INF cost if not found.
+	pathes.clear();
+	for (const auto &slot : slots)
+	{
+		if (slot[0] < 0)
+		{
+			pathes.append(nullptr, nullptr, _DBL_MAX);
+		}
+		else
+		{
+			pathes.append(stores[slot[0]][slot[1]]);
+		}
+	}
+}
+
+double ShortestPathEngine::pathLength(const VecInt &route) const
+{
+	double length = 0.0;
+	for (size_t i = 1; i < route.size(); ++i)
+	{
+		length += _graph->findWeight(route[i - 1], route[i]);
+	}
+
+	return length;
+}
+
+void ShortestPathEngine::DijkstraAlgo(int begVerticeInd, int endVerticeInd,
+                                      DijkstraWorkspace &workspace) const
+{
+	if (_negativeEdgeNum > 0 && !_isReweighted)
+	{
+		BellmanFordAlgo(begVerticeInd, workspace);
+		return;
+	}
+
+	workspace.prepare(_graph->verticeNum(), begVerticeInd);
+	auto weightOf = [this](int, int e)
+	{
+		return _graph->weight(e);
+	};
+
+	if (_negativeEdgeNum > 0)
+	{
+		// reduced edge values are non-negative, up to rounding; path lengths
+		// are restored from reduced ones afterwards.
+		auto reducedWeightOf = [this](int ver, int e)
+		{
+			double weight = _graph->weight(e) + potential(ver) - potential(_graph->target(e));
+			return (std::max)(weight, 0.0);
+		};
+		DijkstraAlgo(begVerticeInd, endVerticeInd, workspace, workspace.heap, reducedWeightOf);
+
+		double begPotential = potential(begVerticeInd);
+		for (int ver : workspace.touched)
+		{
+			workspace.dist[ver] += potential(ver) - begPotential;
+		}
+	}
+	else if (_isIntegral)
+	{
+		DijkstraAlgo(begVerticeInd, endVerticeInd, workspace, workspace.radixHeap, weightOf);
+	}
+	else
+	{
+		DijkstraAlgo(begVerticeInd, endVerticeInd, workspace, workspace.heap, weightOf);
+	}
+}
+
+bool ShortestPathEngine::BellmanFordAlgo(int begVerticeInd,
+        DijkstraWorkspace &workspace) const
+{
+	// queue based Bellman-Ford algorithm(SPFA), in O(VE) at worst.
+	int size = _graph->verticeNum();
+	workspace.prepare(size, begVerticeInd);
+
+	VecDbl &dist = workspace.dist;
+	VecBool &isQueued = workspace.book;
+	VecInt &hops = workspace.hops;
+	std::deque<int> &queue = workspace.queue;
+	SearchStats &stats = workspace.stats;
+	stats.queryNum++;
+
+	queue.emplace_back(begVerticeInd);
+	isQueued[begVerticeInd] = true;
+	while (!queue.empty())
+	{
+		int postVerInd = queue.front();
+		queue.pop_front();
+		isQueued[postVerInd] = false;
+		stats.settledVertices++;
+
+		for (int e = _graph->edgeBegin(postVerInd); e < _graph->edgeEnd(postVerInd); ++e)
+		{
+			int j = _graph->target(e);
+			double currDist = dist[postVerInd] + _graph->weight(e);
+			if (dist[j] > currDist)
+			{
+				workspace.touch(j, currDist, postVerInd);
+				hops[j] = hops[postVerInd] + 1;
+				stats.relaxedEdges++;
+				if (hops[j] >= size)
+				{
+					// negative cycle reachable from begin vertice, no path at all.
+					workspace.prepare(size, begVerticeInd);
+					return false;
+				}
+				if (!isQueued[j])
+				{
+					isQueued[j] = true;
+					queue.emplace_back(j);
+				}
+			}
+		}
+	}
+
+	// book marks vertices with known shortest path, as Dijkstra algorithm.
+	for (int ver : workspace.touched)
+	{
+		isQueued[ver] = true;
+	}
+	return true;
+}
+
+template<typename Heap, typename WeightOf>
+void ShortestPathEngine::DijkstraAlgo(int begVerticeInd, int endVerticeInd,
+                                      DijkstraWorkspace &workspace, Heap &heap,
+                                      const WeightOf &weightOf) const
+{
+	VecDbl &dist = workspace.dist;
+	VecBool &book = workspace.book;
+	SearchStats &stats = workspace.stats;
+	stats.queryNum++;
+
+	heap.push(begVerticeInd, 0.0);
+	while (!heap.empty())
+	{
+		// the next vertice making up the shortest path.
+		int postVerInd = heap.pop();
+		if (book[postVerInd])
+		{
+			continue;  // outdated entry.
+		}
+
+		book[postVerInd] = true;
+		stats.settledVertices++;
+		if (postVerInd == endVerticeInd)
+		{
+			break;  // shortest path to end vertice found.
+		}
+
+		// iterate over out edges to update distance.
+		for (int e = _graph->edgeBegin(postVerInd); e < _graph->edgeEnd(postVerInd); ++e)
+		{
+			int j = _graph->target(e);
+			double currDist = dist[postVerInd] + weightOf(postVerInd, e);
+			if (!book[j] && dist[j] > currDist)
+			{
+				workspace.touch(j, currDist, postVerInd);
+				heap.push(j, currDist);
+				stats.relaxedEdges++;
+			}
+		}
+	}
+}
+
+void ShortestPathEngine::AStarAlgo(int begVerticeInd, int endVerticeInd,
+                                   DijkstraWorkspace &workspace) const
+{
+	workspace.prepare(_graph->verticeNum(), begVerticeInd);
+
+	VecDbl &dist = workspace.dist;
+	VecBool &book = workspace.book;
+	IndexedMinHeap &heap = workspace.heap;
+	SearchStats &stats = workspace.stats;
+	stats.queryNum++;
+
+	// vertices are ordered by path length plus estimated remaining length.
+	auto estimate = [this, endVerticeInd](int ver)
+	{
+		return _heuristic ? _heuristic(ver, endVerticeInd) : 0.0;
+	};
+
+	heap.push(begVerticeInd, estimate(begVerticeInd));
+	while (!heap.empty())
+	{
+		int postVerInd = heap.pop();
+		book[postVerInd] = true;
+		stats.settledVertices++;
+		if (postVerInd == endVerticeInd)
+		{
+			break;  // shortest path to end vertice found.
+		}
+
+		for (int e = _graph->edgeBegin(postVerInd); e < _graph->edgeEnd(postVerInd); ++e)
+		{
+			int j = _graph->target(e);
+			double currDist = dist[postVerInd] + _graph->weight(e);
+			if (dist[j] > currDist)
+			{
+				// settled vertice is reopened if heuristic is inconsistent.
+				book[j] = false;
+				workspace.touch(j, currDist, postVerInd);
+				heap.push(j, currDist + estimate(j));
+				stats.relaxedEdges++;
+			}
+		}
+	}
+}
+
+int ShortestPathEngine::bidirectionalAlgo(int begVerticeInd, int endVerticeInd,
+        DijkstraWorkspace &workspace, DijkstraWorkspace &backWorkspace) const
+{
+	int size = _graph->verticeNum();
+	workspace.prepare(size, begVerticeInd);
+	backWorkspace.prepare(size, endVerticeInd);
+	workspace.stats.queryNum++;
+
+	// shortest path length found so far and its meeting vertice.
+	double minDist = (begVerticeInd == endVerticeInd) ? 0.0 : _DBL_MAX;
+	int meetVerInd = (begVerticeInd == endVerticeInd) ? begVerticeInd : -1;
+
+	workspace.heap.push(begVerticeInd, 0.0);
+	backWorkspace.heap.push(endVerticeInd, 0.0);
+	while (!workspace.heap.empty() && !backWorkspace.heap.empty())
+	{
+		// no shorter path can be found once both frontiers exceed it.
+		if (workspace.heap.topKey() + backWorkspace.heap.topKey() >= minDist)
+		{
+			break;
+		}
+
+		// expand the smaller frontier.
+		bool isForward = workspace.heap.size() <= backWorkspace.heap.size();
+		DijkstraWorkspace &curr = isForward ? workspace : backWorkspace;
+		DijkstraWorkspace &other = isForward ? backWorkspace : workspace;
+		const CsrGraph &graph = isForward ? *_graph : *_reverseGraph;
+
+		int postVerInd = curr.heap.pop();
+		curr.book[postVerInd] = true;
+		curr.stats.settledVertices++;
+
+		for (int e = graph.edgeBegin(postVerInd); e < graph.edgeEnd(postVerInd); ++e)
+		{
+			int j = graph.target(e);
+			double currDist = curr.dist[postVerInd] + graph.weight(e);
+			if (!curr.book[j] && curr.dist[j] > currDist)
+			{
+				curr.touch(j, currDist, postVerInd);
+				curr.heap.push(j, currDist);
+				curr.stats.relaxedEdges++;
+			}
+
+			if (other.dist[j] < _DBL_MAX && currDist + other.dist[j] < minDist)
+			{
+				minDist = currDist + other.dist[j];
+				meetVerInd = j;
+			}
+		}
+	}
+
+	return meetVerInd;
+}
+
+VecInt ShortestPathEngine::parsePath(const VecInt &path, int begVerticeInd,
+                                     int endVerticeInd)
+{
+	VecInt route{endVerticeInd};
+
+	int preVerInd = endVerticeInd;
+	while (preVerInd != begVerticeInd)
+	{
+		preVerInd = path[preVerInd];
+		route.emplace_back(preVerInd);
+	}
+
+	std::reverse(route.begin(), route.end());
+	return route;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////
 // class DirectedGraphHandler.
 /////////////////////////////////////////////////////////////////////////////////
 
-bool DirectedGraphHandler::setGraph(const Graph &graph)
+const char *graphStatusName(GraphStatus status)
+{
+	static const char *names[GRAPH_STATUS_NUM] =
+	{
+		"ok", "invalid_vertice", "invalid_argument", "empty_graph", "negative_cycle", "no_path"
+	};
+	return names[static_cast<int>(status)];
+}
+
+DirectedGraphHandler::DirectedGraphHandler(const DirectedGraphHandler &other)
+{
+	*this = other;
+}
+
+DirectedGraphHandler::DirectedGraphHandler(DirectedGraphHandler &&other) noexcept
+{
+	*this = std::move(other);
+}
+
+DirectedGraphHandler &DirectedGraphHandler::operator=(const DirectedGraphHandler &other)
+{
+	if (this != &other)
+	{
+		_currBegVerticeInd = other._currBegVerticeInd;
+		_currEndVerticeInd = other._currEndVerticeInd;
+		_pathes = other._pathes;
+		_groupedPathes = other._groupedPathes;
+		_route = other._route;
+		_workspace = other._workspace;
+		_backWorkspace = other._backWorkspace;
+		_pathTreeCapacity = other._pathTreeCapacity;
+		_pathTreeOrder = other._pathTreeOrder;
+		_pathTrees = other._pathTrees;
+		_graph = other._graph;
+		_reverseGraph = other._reverseGraph;
+		_engine = other._engine;
+		_verIds = other._verIds;
+		_verIdToInd = other._verIdToInd;
+		_lastStatus = other._lastStatus;
+		_metrics = other._metrics;
+		_logLevel = other._logLevel;
+
+		// pathes name vertices by views of this handler's table.
+		_pathes.setNames(&_verIds);
+	}
+	return *this;
+}
+
+DirectedGraphHandler &DirectedGraphHandler::operator=(DirectedGraphHandler &&other) noexcept
+{
+	if (this != &other)
+	{
+		_currBegVerticeInd = other._currBegVerticeInd;
+		_currEndVerticeInd = other._currEndVerticeInd;
+		_pathes = std::move(other._pathes);
+		_groupedPathes = std::move(other._groupedPathes);
+		_route = std::move(other._route);
+		_workspace = std::move(other._workspace);
+		_backWorkspace = std::move(other._backWorkspace);
+		_pathTreeCapacity = other._pathTreeCapacity;
+		_pathTreeOrder = std::move(other._pathTreeOrder);
+		_pathTrees = std::move(other._pathTrees);
+		_graph = std::move(other._graph);
+		_reverseGraph = std::move(other._reverseGraph);
+		_engine = std::move(other._engine);
+		_verIds = std::move(other._verIds);
+		_verIdToInd = std::move(other._verIdToInd);
+		_lastStatus = other._lastStatus;
+		_metrics = std::move(other._metrics);
+		_logLevel = other._logLevel;
+
+		_pathes.setNames(&_verIds);
+		other._pathes.setNames(&other._verIds);
+	}
+	return *this;
+}
+
+bool DirectedGraphHandler::setGraph(const Graph &graph)
+{
+	// collect all vertices in order as interned table.
+	VecStr verIds;
+	verIds.reserve(2 * graph.size());
+	std::for_each(graph.begin(), graph.end(), [&verIds](const auto & iter)
+	{
+		verIds.emplace_back(std::get<0>(iter));
+		verIds.emplace_back(std::get<1>(iter));
+	});
+	std::sort(verIds.begin(), verIds.end());
+	verIds.erase(std::unique(verIds.begin(), verIds.end()), verIds.end());
+	resetVertices(std::move(verIds));
+
+	// generate CSR storage of directed graph; distance between a vertice and
+	// itself is 0.0 and between unconnected vertices is INF implicitly.
+	vector<CsrEdge> edges;
+	edges.reserve(graph.size());
+	std::for_each(graph.begin(), graph.end(), [this, &edges](const auto & iter)
+	{
+		edges.push_back({_verIdToInd[std::get<0>(iter)], _verIdToInd[std::get<1>(iter)],
+		                 std::get<2>(iter)});
+	});
+	auto csrGraph = std::make_shared<CsrGraph>();
+	csrGraph->build(static_cast<int>(_verIds.size()), edges);
+	resetGraph(csrGraph, std::make_shared<CsrGraph>(csrGraph->reversed()));
+
+	return isGraphConnected();
+}
+
+bool DirectedGraphHandler::loadGraph(const string &file, int threadNum)
+{
+	VecStr verIds;
+	vector<CsrEdge> edges;
+	if (!EdgeListLoader::load(file, verIds, edges, threadNum))
+	{
+		return false;
+	}
+
+	auto csrGraph = std::make_shared<CsrGraph>();
+	csrGraph->build(static_cast<int>(verIds.size()), edges);
+	vector<CsrEdge>().swap(edges);
+	resetVertices(std::move(verIds));
+	resetGraph(csrGraph, std::make_shared<CsrGraph>(csrGraph->reversed()));
+
+	// same as `setGraph()` of the same edges.
+	return isGraphConnected();
+}
+
+bool DirectedGraphHandler::saveSnapshot(const string &file) const
+{
+	return GraphSnapshot::save(file, _verIds, *_graph, *_reverseGraph);
+}
+
+bool DirectedGraphHandler::loadSnapshot(const string &file)
+{
+	// CSR arrays are used in place of mapped file.
+	VecStr verIds;
+	auto csrGraph = std::make_shared<CsrGraph>();
+	auto reverseGraph = std::make_shared<CsrGraph>();
+	if (!GraphSnapshot::load(file, verIds, *csrGraph, *reverseGraph))
+	{
+		return false;
+	}
+
+	resetVertices(std::move(verIds));
+	resetGraph(csrGraph, reverseGraph);
+	return true;
+}
+
+void DirectedGraphHandler::resetVertices(VecStr &&verIds)
+{
+	_verIds = std::move(verIds);
+	_verIds.shrink_to_fit();
+
+	// map vertices to its index in table.
+	_verIdToInd.clear();
+	_verIdToInd.reserve(_verIds.size());
+	for (int i = 0; i < static_cast<int>(_verIds.size()); ++i)
+	{
+		_verIdToInd.emplace(_verIds[i], i);
+	}
+}
+
+void DirectedGraphHandler::resetGraph(shared_ptr<CsrGraph> graph,
+                                      shared_ptr<CsrGraph> reverseGraph)
+{
+	_graph = std::move(graph);
+	_reverseGraph = std::move(reverseGraph);
+	_engine.setGraph(_graph, _reverseGraph);
+	clearPathTrees();
+}
+
+bool DirectedGraphHandler::isGraphConnected() const
+{
+	// to check for weak connectivity of directed graph.
+	VecInt components;
+	return GraphConnectivity::weakComponents(*_graph, components) == 1;
+}
+
+void DirectedGraphHandler::getWeaklyConnectedComponents(vector<VecStr> &components) const
 {
-	// collect all vertices and map it.
-	std::set<string> vertices;
-	std::for_each(graph.begin(), graph.end(), [&vertices](const auto & iter)
-	{
-		vertices.emplace(std::get<0>(iter));
-		vertices.emplace(std::get<1>(iter));
-	});
+	VecInt labels;
+	int count = GraphConnectivity::weakComponents(*_graph, labels);
+	groupVertices(labels, count, components);
+}
 
-	// map vertices.
-	_verIdToInd.clear();
-	int ind = 0;
-	std::for_each(vertices.begin(), vertices.end(), [this, &ind](const auto & iter)
+void DirectedGraphHandler::getStronglyConnectedComponents(vector<VecStr> &components) const
+{
+	VecInt labels;
+	int count = GraphConnectivity::strongComponents(*_graph, labels);
+	groupVertices(labels, count, components);
+}
+
+void DirectedGraphHandler::groupVertices(const VecInt &components, int count,
+        vector<VecStr> &verticeGroups) const
+{
+	verticeGroups.assign(count, VecStr());
+	for (int i = 0; i < static_cast<int>(components.size()); ++i)
 	{
-		_verIdToInd.emplace(iter, ind++);
-	});
+		verticeGroups[components[i]].emplace_back(_verIds[i]);
+	}
+}
 
+void DirectedGraphHandler::getGraphMatrix(GraphMatrix &matrix) const
+{
 	// generate adjacent matrix of directed graph:
 	// 1. distance between a vertice and itself is 0.0 ;
 	// 2. distance between unconnected vertices is INF;
 	// 3. distance between connected vertices is loaded.
-	_matrix = GraphMatrix(vertices.size(), VecDbl(vertices.size(), _DBL_MAX));
-	for (int i = 0; i < vertices.size() ; ++i)
+	int size = _graph->verticeNum();
+	matrix = GraphMatrix(size, VecDbl(size, _DBL_MAX));
+	for (int i = 0; i < size; ++i)
 	{
-		_matrix[i][i] = 0.0;
+		matrix[i][i] = 0.0;
+		for (int e = _graph->edgeBegin(i); e < _graph->edgeEnd(i); ++e)
+		{
+			matrix[i][_graph->target(e)] = _graph->weight(e);
+		}
 	}
-	std::for_each(graph.begin(), graph.end(), [this](const auto & iter)
+}
+
+void DirectedGraphHandler::getPathes(vector<VecStr> &pathes) const
+{
+	pathes.clear();
+
+	for (size_t i = 0; i < _pathes.size(); ++i)
 	{
-		int begInd = _verIdToInd[std::get<0>(iter)];
-		int endInd = _verIdToInd[std::get<1>(iter)];
-		_matrix[begInd][endInd] = std::get<2>(iter);
-	});
+		VecStr path;
+		for (int ver : _pathes[i])
+		{
+			path.emplace_back(getVerticeId(ver));
+		}
 
-	return isGraphConnected();
+		pathes.emplace_back(path);
+	}
 }
 
-bool DirectedGraphHandler::isGraphConnected()
+const PathStore &DirectedGraphHandler::getPathResults() const
 {
-	// to check for weak connectivity of directed graph.
+	return _pathes;
+}
 
-	int count = 0;
-	int size = static_cast<int>(_matrix.size());
-	VecInt visited(size, 0);
+ShortestPathEngine DirectedGraphHandler::getQueryEngine() const
+{
+	return _engine;
+}
+
+int DirectedGraphHandler::getVerticeIndex(const string &verId) const
+{
+	auto iter = _verIdToInd.find(verId);
+	return (iter != _verIdToInd.end()) ? iter->second : -1;
+}
+
+const string &DirectedGraphHandler::getVerticeId(int ind) const
+{
+	static const string empty;
+	return (ind >= 0 && ind < static_cast<int>(_verIds.size())) ? _verIds[ind] : empty;
+}
+
+bool DirectedGraphHandler::runDijkstraAlgo(const vector<array<string, 2>> &vertices)
+{
+	clearPathes();
+	GraphStatus status = checkGraphValid();
+	if (status != GraphStatus::Ok)
+	{
+		return failQuery(status, string(), string());
+	}
 
-	// lambda function used for recursive.
-	std::function<void(int ind)> deepFirstSearch;
-	deepFirstSearch = [this, &deepFirstSearch, &visited, &count, size](int ind)
+	// group requests by begin vertice.
+	VecInt sources;
+	unordered_map<int, VecInt> groups;
+	VecInt endInds(vertices.size());
+	for (int i = 0; i < static_cast<int>(vertices.size()); ++i)
 	{
-		visited[ind] = 1;
-		count ++;
+		int begInd = getVerticeIndex(vertices[i][0]);
+		endInds[i] = getVerticeIndex(vertices[i][1]);
+		if (begInd < 0 || endInds[i] < 0)
+		{
+			// return `false` once Dijkstra algorithm failed.
+			return failQuery(GraphStatus::InvalidVertice, vertices[i][0], vertices[i][1]);
+		}
+
+		if (groups.count(begInd) < 1)
+		{
+			sources.emplace_back(begInd);
+		}
+		groups[begInd].emplace_back(i);
+	}
 
-		for (int j = 0; j < size; ++j)
+	// one shortest path tree for each begin vertice answers all its requests;
+	// pathes are stored in order of begin vertice, then in input order.
+	VecInt slots(vertices.size());
+	_groupedPathes.clear();
+	for (int begInd : sources)
+	{
+		const ShortestPathTree &tree = searchPathTree(begInd);
+		for (int i : groups[begInd])
 		{
-			double link = (std::min)(_matrix[ind][j], _matrix[j][ind]);
-			if (visited[j] == 0 && link < 1.0e6)
+			int endInd = endInds[i];
+			if (tree.path[endInd] < 0)
 			{
-				deepFirstSearch(j);
+				return failQuery(GraphStatus::NoPath, vertices[i][0], vertices[i][1]);
 			}
+
+			slots[i] = static_cast<int>(_groupedPathes.size());
+			_groupedPathes.appendFromTree(tree.path, begInd, endInd, tree.dist[endInd]);
 		}
-	};
-	deepFirstSearch(0);
+	}
 
-	// truely connected if all vertices visited.
-	return (count == size) ? true : false;
+	for (int slot : slots)
+	{
+		_pathes.append(_groupedPathes[slot]);
+	}
+	return passQuery(string(), string());
 }
 
-void DirectedGraphHandler::getGraphMatrix(GraphMatrix &matrix) const
+bool DirectedGraphHandler::runDijkstraAlgo(const string &begVertice)
+{
+	clearPathes();
+	GraphStatus status = checkGraphValid();
+	_currBegVerticeInd = getVerticeIndex(begVertice);
+	if (status == GraphStatus::Ok && _currBegVerticeInd < 0)
+	{
+		status = GraphStatus::InvalidVertice;
+	}
+	if (status != GraphStatus::Ok)
+	{
+		return failQuery(status, begVertice, string());
+	}
+
+	// pathes to all other reachable vertices in order of index.
+	const ShortestPathTree &tree = searchPathTree(_currBegVerticeInd);
+	for (int i = 0; i < _graph->verticeNum(); ++i)
+	{
+		if (i != _currBegVerticeInd && tree.path[i] >= 0)
+		{
+			_pathes.appendFromTree(tree.path, _currBegVerticeInd, i, tree.dist[i]);
+		}
+	}
+
+	return passQuery(begVertice, string());
+}
+
+bool DirectedGraphHandler::runDijkstraAlgo(const string &begVertice,
+        const string &endVertice)
 {
-	matrix = _matrix;
+	clearPathes();
+	GraphStatus status = checkPairValid(begVertice, endVertice);
+	if (status != GraphStatus::Ok)
+	{
+		return failQuery(status, begVertice, endVertice);
+	}
+
+	// answer from cached shortest path tree if any.
+	auto iter = _pathTrees.find(_currBegVerticeInd);
+	if (iter != _pathTrees.end())
+	{
+		const ShortestPathTree &tree = iter->second;
+		if (tree.path[_currEndVerticeInd] >= 0)
+		{
+			_pathes.appendFromTree(tree.path, _currBegVerticeInd, _currEndVerticeInd,
+			                       tree.dist[_currEndVerticeInd]);
+		}
+	}
+	else if (_engine.searchPath(_currBegVerticeInd, _currEndVerticeInd, _workspace,
+	                            _backWorkspace, _route))
+	{
+		_pathes.append(_route.data(), _route.data() + _route.size(),
+		               _engine.pathLength(_route));
+	}
+
+	// the shortest path found or not.
+	return _pathes.empty() ? failQuery(GraphStatus::NoPath, begVertice, endVertice)
+	       : passQuery(begVertice, endVertice);
 }
 
-void DirectedGraphHandler::getPathes(vector<VecStr> &pathes) const
+bool DirectedGraphHandler::runDijkstraAlgo(const vector<array<string, 2>> &vertices,
+        int threadNum)
 {
-	pathes.clear();
+	clearPathes();
+	GraphStatus status = checkGraphValid();
+	if (status != GraphStatus::Ok)
+	{
+		return failQuery(status, string(), string());
+	}
 
-	for (const auto &route : _pathRoutes)
+	vector<array<int, 2>> pairs;
+	pairs.reserve(vertices.size());
+	for (const auto &vers : vertices)
 	{
-		VecStr path;
-		for (const auto &ver : route)
+		pairs.push_back({getVerticeIndex(vers[0]), getVerticeIndex(vers[1])});
+		if (pairs.back()[0] < 0 || pairs.back()[1] < 0)
 		{
-			path.emplace_back(getVerticeId(ver));
+			// return `false` once Dijkstra algorithm failed.
+			return failQuery(GraphStatus::InvalidVertice, vers[0], vers[1]);
 		}
+	}
 
-		pathes.emplace_back(path);
+	// search in parallel; pathes are in input order.
+	_engine.searchPathes(pairs, _pathes, threadNum, &_workspace.stats);
+	for (size_t i = 0; i < _pathes.size(); ++i)
+	{
+		if (_pathes[i].size() == 0)
+		{
+			return failQuery(GraphStatus::NoPath, vertices[i][0], vertices[i][1]);
+		}
 	}
+
+	return passQuery(string(), string());
 }
 
-string DirectedGraphHandler::getVerticeId(int ind) const
+bool DirectedGraphHandler::runFloydWarshallAlgo(VecDbl &matrix, int threadNum)
 {
-	auto iter = std::find_if(_verIdToInd.begin(), _verIdToInd.end(),
-	[ind](const auto & elem) {return elem.second == ind;});
+	// row-major lengths of shortest pathes, _DBL_MAX if unreachable; negative
+	// cycle is found by engine once graph changes.
+	GraphStatus status = checkGraphValid();
+	if (status != GraphStatus::Ok)
+	{
+		matrix.clear();
+		return failQuery(status, string(), string());
+	}
 
-	return (iter != _verIdToInd.end()) ? iter->first : "";
+	return AllPairsShortestPath::FloydWarshallAlgo(*_graph, matrix, threadNum)
+	       ? passQuery(string(), string())
+	       : failQuery(GraphStatus::NegativeCycle, string(), string());
 }
 
-bool DirectedGraphHandler::runDijkstraAlgo(const vector<array<string, 2>> &vertices)
+bool DirectedGraphHandler::runFloydWarshallAlgo(GraphMatrix &matrix, int threadNum)
 {
-	_isMultiSets = true;
-	bool status = true;
+	VecDbl dist;
+	bool status = runFloydWarshallAlgo(dist, threadNum);
 
-	for (const auto &vers : vertices)
+	// no matrix on failure.
+	size_t size = status ? _graph->verticeNum() : 0;
+	matrix.resize(size);
+	for (size_t i = 0; i < size; ++i)
 	{
-		if (!runDijkstraAlgo(vers[0], vers[1]))
-		{
-			status = false;  // return `false` once Dijkstra algorithm failed.
-			break;
-		}
+		matrix[i].assign(dist.begin() + i * size, dist.begin() + (i + 1) * size);
 	}
 
-	_isMultiSets = false;
 	return status;
 }
 
-bool DirectedGraphHandler::runDijkstraAlgo(const string &begVertice,
-        const string &endVertice)
+bool DirectedGraphHandler::runYenAlgo(const string &begVertice, const string &endVertice,
+                                      int k)
 {
-	if (!checkDijkstraAlgoValid(begVertice, endVertice))
+	clearPathes();
+	GraphStatus status = (k < 1) ? GraphStatus::InvalidArgument
+	                     : checkPairValid(begVertice, endVertice);
+	if (status != GraphStatus::Ok)
 	{
-		clearCurrStatus();
-		return false;
+		return failQuery(status, begVertice, endVertice);
 	}
 
-	GraphMatrix matrix = _matrix;
-	try
+	// at most k pathes in order of length.
+	KShortestPathes searcher(_engine);
+	vector<VecInt> routes;
+	VecDbl lengths;
+	if (!searcher.YenAlgo(_currBegVerticeInd, _currEndVerticeInd, k, routes, lengths))
 	{
-		_currBegVerticeInd = _verIdToInd[begVertice];
-		_currEndVerticeInd = _verIdToInd[endVertice];
-
-		initDijkstraAlgoStatus();
-		DijkstraAlgo();
+		return failQuery(GraphStatus::NoPath, begVertice, endVertice);
 	}
-	catch (...)
+
+	for (size_t i = 0; i < routes.size(); ++i)
 	{
-		std::cerr << "Dijkstra crashed" << _LOCA;
+		_pathes.append(routes[i].data(), routes[i].data() + routes[i].size(), lengths[i]);
 	}
+	return passQuery(begVertice, endVertice);
+}
 
-	_matrix = matrix;  // recover graph matrix.
-	if (_path[_currEndVerticeInd] >= 0) // the shortest path found.
+bool DirectedGraphHandler::addVertice(const string &verId)
+{
+	if (_verIdToInd.count(verId) > 0)
 	{
-		_pathRoutes.emplace_back(parsePath());
-		return true;
+		if (_logLevel >= LogLevel::Error)
+		{
+			std::cerr << "vertice exists: " << verId << _LOCA;
+		}
+		return false;
 	}
-	else
+
+	internVertice(verId);
+	return true;
+}
+
+bool DirectedGraphHandler::addEdge(const string &begVertice, const string &endVertice,
+                                   double value)
+{
+	// unknown vertices are added as well.
+	int begInd = internVertice(begVertice);
+	int endInd = internVertice(endVertice);
+	if (_graph->findEdge(begInd, endInd) >= 0)
 	{
-		std::cerr << "no path found: "
-		          << begVertice << " -> " << endVertice << _LOCA;
+		if (_logLevel >= LogLevel::Error)
+		{
+			std::cerr << "edge exists: " << begVertice << " -> " << endVertice << _LOCA;
+		}
+		return false;
+	}
+
+	detachGraph();
+	_graph->insertEdge(begInd, endInd, value);
+	_reverseGraph->insertEdge(endInd, begInd, value);
+	_engine.notifyEdgeChanged(begInd, endInd, _DBL_MAX, value);
+	updatePathTrees(begInd, endInd, _DBL_MAX, value);
 
-		clearCurrStatus();
+	return true;
+}
+
+bool DirectedGraphHandler::removeEdge(const string &begVertice, const string &endVertice)
+{
+	int begInd = getVerticeIndex(begVertice);
+	int endInd = getVerticeIndex(endVertice);
+	int edge = (begInd < 0 || endInd < 0) ? -1 : _graph->findEdge(begInd, endInd);
+	if (edge < 0)
+	{
+		if (_logLevel >= LogLevel::Error)
+		{
+			std::cerr << "edge not found: " << begVertice << " -> " << endVertice << _LOCA;
+		}
 		return false;
 	}
+
+	double value = _graph->weight(edge);
+	detachGraph();
+	_graph->eraseEdge(begInd, endInd);
+	_reverseGraph->eraseEdge(endInd, begInd);
+	_engine.notifyEdgeChanged(begInd, endInd, value, _DBL_MAX);
+	updatePathTrees(begInd, endInd, value, _DBL_MAX);
+
+	return true;
 }
 
-bool DirectedGraphHandler::checkDijkstraAlgoValid(const string &begVertice,
-        const string &endVertice)
+bool DirectedGraphHandler::setEdgeValue(const string &begVertice, const string &endVertice,
+                                        double value)
 {
-	if (_verIdToInd.count(begVertice) < 1 || _verIdToInd.count(endVertice) < 1)
+	int begInd = getVerticeIndex(begVertice);
+	int endInd = getVerticeIndex(endVertice);
+	int edge = (begInd < 0 || endInd < 0) ? -1 : _graph->findEdge(begInd, endInd);
+	if (edge < 0)
 	{
-		std::cerr << "invalid vertices: " << begVertice << " , " << endVertice
-		          << _LOCA;
+		if (_logLevel >= LogLevel::Error)
+		{
+			std::cerr << "edge not found: " << begVertice << " -> " << endVertice << _LOCA;
+		}
 		return false;
 	}
 
-	if (_matrix.empty())
+	double oldValue = _graph->weight(edge);
+	detachGraph();
+	_graph->setWeight(begInd, endInd, value);
+	_reverseGraph->setWeight(endInd, begInd, value);
+	_engine.notifyEdgeChanged(begInd, endInd, oldValue, value);
+	updatePathTrees(begInd, endInd, oldValue, value);
+
+	return true;
+}
+
+void DirectedGraphHandler::setSearchMode(SearchMode mode)
+{
+	_engine.setSearchMode(mode);
+}
+
+void DirectedGraphHandler::setHeuristic(const ShortestPathEngine::Heuristic &heuristic)
+{
+	_engine.setHeuristic(heuristic);
+}
+
+SearchStats DirectedGraphHandler::getSearchStats() const
+{
+	SearchStats stats = _workspace.stats;
+	stats.settledVertices += _backWorkspace.stats.settledVertices;
+	stats.relaxedEdges += _backWorkspace.stats.relaxedEdges;
+
+	return stats;
+}
+
+void DirectedGraphHandler::resetSearchStats()
+{
+	_workspace.stats = SearchStats();
+	_backWorkspace.stats = SearchStats();
+}
+
+bool DirectedGraphHandler::buildContractionHierarchy()
+{
+	auto hierarchy = std::make_shared<ContractionHierarchy>();
+	if (!hierarchy->build(*_graph))
 	{
-		std::cerr << "empty graph matrix" << _LOCA;
 		return false;
 	}
 
-	for (const auto &row : _matrix)
+	_engine.setHierarchy(hierarchy);
+	return true;
+}
+
+bool DirectedGraphHandler::saveContractionHierarchy(const string &file) const
+{
+	if (!_engine.hierarchy())
 	{
-		auto iter = std::find_if(row.begin(), row.end(), [](const double val)
+		if (_logLevel >= LogLevel::Error)
 		{
-			return val < 0.0;
-		});
+			std::cerr << "no contraction hierarchy built" << _LOCA;
+		}
+		return false;
+	}
+
+	return _engine.hierarchy()->save(file);
+}
+
+bool DirectedGraphHandler::loadContractionHierarchy(const string &file)
+{
+	auto hierarchy = std::make_shared<ContractionHierarchy>();
+	if (!hierarchy->load(file))
+	{
+		return false;
+	}
 
-		if (iter != row.end())
+	if (!hierarchy->isMatched(*_graph))
+	{
+		if (_logLevel >= LogLevel::Error)
 		{
-			std::cerr << "invalid graph: has negative edge value" << _LOCA;
-			return false;
+			std::cerr << "contraction hierarchy not matched with graph: " << file << _LOCA;
 		}
+		return false;
 	}
 
+	_engine.setHierarchy(hierarchy);
 	return true;
 }
 
-void DirectedGraphHandler::initDijkstraAlgoStatus()
+void DirectedGraphHandler::setPathTreeCapacity(size_t capacity)
 {
-	_dist = _matrix[_currBegVerticeInd];
+	// keep one tree at least to answer batch queries.
+	_pathTreeCapacity = (std::max)(capacity, size_t(1));
+	while (_pathTreeOrder.size() > _pathTreeCapacity)
+	{
+		_pathTrees.erase(_pathTreeOrder.front());
+		_pathTreeOrder.pop_front();
+	}
+}
 
-	_book = VecBool(_matrix.size(), false);
-	_book[_currBegVerticeInd] = true;
+const ShortestPathTree &DirectedGraphHandler::searchPathTree(int begVerticeInd)
+{
+	auto iter = _pathTrees.find(begVerticeInd);
+	if (iter != _pathTrees.end())
+	{
+		return iter->second;
+	}
 
-	_path.clear();
-	std::for_each(_dist.begin(), _dist.end(), [this](double ds)
+	// evict the oldest tree once cache is full.
+	if (_pathTreeOrder.size() >= _pathTreeCapacity)
 	{
-		(ds < _DBL_MAX - _DBL_EPSILON)
-		? _path.emplace_back(_currBegVerticeInd)
-		: _path.emplace_back(-1);
-	});
+		_pathTrees.erase(_pathTreeOrder.front());
+		_pathTreeOrder.pop_front();
+	}
+
+	// search all vertices from begin vertice.
+	_engine.DijkstraAlgo(begVerticeInd, -1, _workspace);
+
+	ShortestPathTree &tree = _pathTrees[begVerticeInd];
+	tree.source = begVerticeInd;
+	tree.dist = _workspace.dist;
+	tree.path = _workspace.path;
+	_pathTreeOrder.emplace_back(begVerticeInd);
+
+	return tree;
+}
+
+void DirectedGraphHandler::clearPathTrees()
+{
+	_pathTrees.clear();
+	_pathTreeOrder.clear();
+}
 
-	if (!_isMultiSets)
+int DirectedGraphHandler::internVertice(const string &verId)
+{
+	auto iter = _verIdToInd.find(verId);
+	if (iter != _verIdToInd.end())
+	{
+		return iter->second;
+	}
+
+	detachGraph();
+	int ind = _graph->addVertice();
+	_reverseGraph->addVertice();
+	_engine.notifyGraphChanged();
+	_verIds.emplace_back(verId);
+	_verIdToInd.emplace(verId, ind);
+
+	// new vertice is unreachable from sources of cached trees.
+	for (auto &iter : _pathTrees)
 	{
-		_pathRoutes.clear();
+		iter.second.dist.emplace_back(_DBL_MAX);
+		iter.second.path.emplace_back(-1);
 	}
+
+	return ind;
 }
 
-void DirectedGraphHandler::DijkstraAlgo()
+void DirectedGraphHandler::detachGraph()
 {
-	for (int i = 0; i < _matrix.size(); ++i)
+	// copy on write: engines from `getQueryEngine()` keep the old snapshot.
+	if (_graph.use_count() > 2 || _reverseGraph.use_count() > 2)
 	{
-		if (i == _currBegVerticeInd)
-		{
-			continue;
-		}
+		_graph = std::make_shared<CsrGraph>(*_graph);
+		_reverseGraph = std::make_shared<CsrGraph>(*_reverseGraph);
+		_engine.setGraph(_graph, _reverseGraph);
+	}
+}
 
-		int postVerInd = _currBegVerticeInd;
-		double minDist = _DBL_MAX;
+void DirectedGraphHandler::updatePathTrees(int begVerticeInd, int endVerticeInd,
+        double oldValue, double newValue)
+{
+	if (begVerticeInd == endVerticeInd || oldValue == newValue)
+	{
+		return;  // self loop never lies on shortest pathes.
+	}
 
-		// find the next vertice making up the shortest path.
-		for (int j = 0; j < _matrix.size(); ++j)
+	// a shorter edge matters only if it shortens path to its end vertice, and a
+	// longer one only if it's on the tree; other trees are still valid.
+	auto isAffected = [&](const ShortestPathTree & tree)
+	{
+		if (newValue < oldValue)
 		{
-			if (!_book[j] && minDist > _dist[j] + _DBL_EPSILON)
-			{
-				minDist = _dist[j];
-				postVerInd = j;
-			}
+			double begDist = tree.dist[begVerticeInd];
+			return begDist < _DBL_MAX && begDist + newValue < tree.dist[endVerticeInd];
 		}
+		return tree.path[endVerticeInd] == begVerticeInd;
+	};
 
-		// iterate over all other vertices to update distance.
-		_book[postVerInd] = true;
-		for (int j = 0; j < _matrix.size(); ++j)
+	std::deque<int> order;
+	for (int source : _pathTreeOrder)
+	{
+		if (isAffected(_pathTrees[source]))
 		{
-			if (!_book[j] && _dist[j] > _dist[postVerInd] + _matrix[postVerInd][j])
-			{
-				_dist[j] = _dist[postVerInd] + _matrix[postVerInd][j];
-				_path[j] = postVerInd;
-			}
+			_pathTrees.erase(source);
+		}
+		else
+		{
+			order.emplace_back(source);
 		}
 	}
+	_pathTreeOrder.swap(order);
 }
 
-VecInt DirectedGraphHandler::parsePath()
+GraphStatus DirectedGraphHandler::checkGraphValid()
 {
-	VecInt route{_currEndVerticeInd};
+	if (_graph->verticeNum() == 0)
+	{
+		return GraphStatus::EmptyGraph;
+	}
+
+	// negative edge values are validated by engine once after graph changes.
+	return _engine.hasNegativeCycle() ? GraphStatus::NegativeCycle : GraphStatus::Ok;
+}
 
-	int preVerInd = _currEndVerticeInd;
-	while (preVerInd != _currBegVerticeInd)
+GraphStatus DirectedGraphHandler::checkPairValid(const string &begVertice,
+        const string &endVertice)
+{
+	GraphStatus status = checkGraphValid();
+	_currBegVerticeInd = getVerticeIndex(begVertice);
+	_currEndVerticeInd = getVerticeIndex(endVertice);
+	if (status == GraphStatus::Ok && (_currBegVerticeInd < 0 || _currEndVerticeInd < 0))
 	{
-		preVerInd = _path[preVerInd];
-		route.emplace_back(preVerInd);
+		status = GraphStatus::InvalidVertice;
 	}
 
-	std::reverse(route.begin(), route.end());
-	return route;
+	return status;
+}
+
+bool DirectedGraphHandler::passQuery(const string &begVertice, const string &endVertice)
+{
+	_lastStatus = GraphStatus::Ok;
+	_metrics.queryNum++;
+	if (_logLevel >= LogLevel::Debug)
+	{
+		logQuery(begVertice, endVertice);
+	}
+
+	return true;
+}
+
+bool DirectedGraphHandler::failQuery(GraphStatus status, const string &begVertice,
+                                     const string &endVertice)
+{
+	// errors are counted; message is built only if logged.
+	_lastStatus = status;
+	_metrics.queryNum++;
+	_metrics.failedNum++;
+	_metrics.statusNum[static_cast<int>(status)]++;
+	if (_logLevel >= LogLevel::Error)
+	{
+		logQuery(begVertice, endVertice);
+	}
+
+	clearCurrStatus();
+	return false;
+}
+
+void DirectedGraphHandler::logQuery(const string &begVertice, const string &endVertice) const
+{
+	std::cerr << "graph query: status=" << graphStatusName(_lastStatus)
+	          << " begin=" << begVertice << " end=" << endVertice
+	          << " pathes=" << _pathes.size() << "\n";
+}
+
+void DirectedGraphHandler::setLogLevel(LogLevel level)
+{
+	_logLevel = level;
+}
+
+GraphStatus DirectedGraphHandler::getLastStatus() const
+{
+	return _lastStatus;
+}
+
+const QueryMetrics &DirectedGraphHandler::getQueryMetrics() const
+{
+	return _metrics;
+}
+
+void DirectedGraphHandler::resetQueryMetrics()
+{
+	_metrics = QueryMetrics();
 }
 
 void DirectedGraphHandler::clearCurrStatus()
 {
-	_path.clear();
-	_book.clear();
-	_dist.clear();
-	_pathRoutes.clear();
+	_pathes.clear();
 	_currBegVerticeInd = -1;
 	_currEndVerticeInd = -1;
 }
 
+void DirectedGraphHandler::clearPathes()
+{
+	// pathes name vertices by views of this handler's table.
+	_pathes.clear();
+	_pathes.setNames(&_verIds);
+}
+
 void DirectedGraphHandler::displayGraphMatrix() const
 {
 	cout << endl << std::setw(12) << "--";
-	for (int i = 0; i < _verIdToInd.size() ; ++i)
+	for (size_t i = 0; i < _verIds.size(); ++i)
 	{
-		cout << std::setw(6) << getVerticeId(i) ;
+		cout << std::setw(6) << _verIds[i] ;
 	}
 	cout << endl;
-	for (int i = 0; i < _verIdToInd.size() ; ++i)
+	GraphMatrix matrix;
+	getGraphMatrix(matrix);
+	for (size_t i = 0; i < _verIds.size(); ++i)
 	{
-		cout << std::setw(12) << getVerticeId(i) ;
-		for (int j = 0; j < _verIdToInd.size(); ++j)
+		cout << std::setw(12) << _verIds[i] ;
+		for (size_t j = 0; j < _verIds.size(); ++j)
 		{
-			if (_matrix[i][j] >= _DBL_MAX - _DBL_EPSILON)
+			if (matrix[i][j] >= _DBL_MAX - _DBL_EPSILON)
 			{
 				cout << std::setw(6) << "nan";
 			}
 			else
 			{
-				cout << std::setw(6) << _matrix[i][j];
+				cout << std::setw(6) << matrix[i][j];
 			}
 		}
 		cout << endl << endl;
@@ -314,9 +2241,9 @@ void DirectedGraphHandler::displayGraphMatrix() const
 void DirectedGraphHandler::displayPathes() const
 {
 	cout << endl << endl;
-	for (const auto &route : _pathRoutes)
+	for (size_t i = 0; i < _pathes.size(); ++i)
 	{
-		for (const auto &ver : route)
+		for (int ver : _pathes[i])
 		{
 			cout << " -> " << getVerticeId(ver) ;
 		}
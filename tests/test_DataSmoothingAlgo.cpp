@@ -5,6 +5,8 @@
 #include <fstream>
 #include <regex>
 #include <numeric>
+#include <random>
+#include <thread>
 
 using namespace ccb;
 
@@ -95,3 +97,468 @@ TEST_CASE("test class DataSmoother")
 }
 
 
+
+TEST_CASE("test DataSmoother kernels")
+{
+	std::mt19937 gen(7);
+	std::normal_distribution<double> noise(0.0, 10.0);
+	VecDbl orig(101);
+	for (auto &val : orig)
+	{
+		val = noise(gen);
+	}
+
+	SECTION("test weights of the fixed windows")
+	{
+		// cubic N7 smoothing by the formulas applied one element by one.
+		VecDbl args0 = {39.0, 8.0, -4.0, -4.0, 1.0, 4.0, -2.0, 42.0};
+		VecDbl args1 = {8.0, 19.0, 16.0, 6.0, -4.0, -7.0, 4.0, 42.0};
+		VecDbl args2 = {-4.0, 16.0, 19.0, 12.0, 2.0, -4.0, 1.0, 42.0};
+		VecDbl args3 = {-2.0, 3.0, 6.0, 7.0, 6.0, 3.0, -2.0, 21.0};
+		auto apply = [](const VecDbl & args, const double * elems, int step)
+		{
+			double res = 0.0;
+			for (int i = 0; i < 7; ++i)
+			{
+				res += args[i] * elems[step * i];
+			}
+			return res / args.back();
+		};
+
+		VecDbl res;
+		DataSmoother::cubicSmoothN7(orig, res);
+		REQUIRE(res.size() == orig.size());
+		size_t last = orig.size() - 1;
+		REQUIRE(res[0] == apply(args0, &orig[0], 1));
+		REQUIRE(res[1] == apply(args1, &orig[0], 1));
+		REQUIRE(res[2] == apply(args2, &orig[0], 1));
+		REQUIRE(res[last] == apply(args0, &orig[last], -1));
+		REQUIRE(res[last - 1] == apply(args1, &orig[last], -1));
+		REQUIRE(res[last - 2] == apply(args2, &orig[last], -1));
+		for (size_t i = 3; i + 3 < orig.size(); ++i)
+		{
+			REQUIRE(res[i] == apply(args3, &orig[i - 3], 1));
+		}
+
+		// weights of each window sum up to divisor.
+		for (int m = 0; m <= static_cast<int>(SmoothMethod::CubicN7); ++m)
+		{
+			const SmoothFilter &filter = DataSmoother::filter(static_cast<SmoothMethod>(m));
+			for (int row = 0; row <= filter.width / 2; ++row)
+			{
+				const double *args = (row < filter.width / 2) ? filter.left + row * (filter.width + 1)
+				                     : filter.interior;
+				REQUIRE(std::accumulate(args, args + filter.width, 0.0) == args[filter.width]);
+			}
+		}
+
+		// linear N3 averages 3 elements.
+		DataSmoother::linearSmoothN3(orig, res);
+		for (size_t i = 1; i + 1 < orig.size(); ++i)
+		{
+			REQUIRE(res[i] == (orig[i - 1] + orig[i] + orig[i + 1]) / 3.0);
+		}
+
+		// quadratic N5 has symmetric interior weights {-3, 12, 17, 12, -3} / 35,
+		// which keep a parabola and spread an impulse by them.
+		VecDbl parabola, impulse(9, 0.0);
+		for (int i = 0; i < 9; ++i)
+		{
+			parabola.push_back(0.5 * i * i - 3.0 * i + 2.0);
+		}
+		DataSmoother::quadraticSmoothN5(parabola, res);
+		for (size_t i = 0; i < parabola.size(); ++i)
+		{
+			REQUIRE(Approx(res[i]).margin(1.0e-12) == parabola[i]);
+		}
+		impulse[4] = 35.0;
+		DataSmoother::quadraticSmoothN5(impulse, res);
+		REQUIRE(VecDbl(res.begin() + 2, res.end() - 2) == VecDbl{-3.0, 12.0, 17.0, 12.0, -3.0});
+	}
+
+	SECTION("test pointer versions")
+	{
+		VecDbl res, res2(orig.size() + 2, -1.0);
+		DataSmoother::quadraticSmoothN5(orig, res);
+		DataSmoother::quadraticSmoothN5(orig.data(), orig.size(), res2.data() + 1);
+		REQUIRE(res2.front() == -1.0);
+		REQUIRE(res2.back() == -1.0);
+		REQUIRE(VecDbl(res2.begin() + 1, res2.end() - 1) == res);
+
+		DataSmoother::smooth(SmoothMethod::QuadraticN5, orig, res2);
+		REQUIRE(res2 == res);
+
+		// series shorter than window is copied.
+		DataSmoother::linearSmoothN7(orig.data(), 6, res2.data());
+		REQUIRE(VecDbl(res2.begin(), res2.begin() + 6) == VecDbl(orig.begin(), orig.begin() + 6));
+
+		SmoothFilter invalid{4, orig.data(), orig.data(), orig.data()};
+		REQUIRE(DataSmoother::smooth(invalid, orig.data(), orig.size(), res2.data()) == false);
+	}
+	SECTION("test SIMD levels against scalar")
+	{
+		// weights of window 9, and lengths with every remainder of SIMD blocks.
+		const double args[10] = {1.0, 2.0, 3.0, 4.0, 5.0, 4.0, 3.0, 2.0, 1.0, 25.0};
+		SmoothFilter wide{9, args, args, args};
+
+		SimdLevel supported = DataSmoother::setSimdLevel(SimdLevel::AVX512);
+		for (size_t size = 0; size < orig.size(); size += 3)
+		{
+			for (int m = 0; m <= static_cast<int>(SmoothMethod::CubicN7) + 1; ++m)
+			{
+				const SmoothFilter &filter = (m > static_cast<int>(SmoothMethod::CubicN7)) ? wide
+				                             : DataSmoother::filter(static_cast<SmoothMethod>(m));
+				DataSmoother::setSimdLevel(SimdLevel::Scalar);
+				REQUIRE(DataSmoother::simdLevel() == SimdLevel::Scalar);
+				VecDbl scalarRes(size);
+				DataSmoother::smooth(filter, orig.data(), size, scalarRes.data());
+
+				for (int level = 1; level <= static_cast<int>(supported); ++level)
+				{
+					DataSmoother::setSimdLevel(static_cast<SimdLevel>(level));
+					VecDbl res(size);
+					DataSmoother::smooth(filter, orig.data(), size, res.data());
+					REQUIRE(res == scalarRes);
+				}
+			}
+		}
+		DataSmoother::setSimdLevel(supported);
+	}
+	SECTION("test savitzkyGolaySmooth()")
+	{
+		// fixed methods are Savitzky-Golay filters of order 1 to 3.
+		const int methods[][3] = {{3, 1, 0}, {5, 1, 1}, {7, 1, 2}, {5, 2, 3}, {7, 2, 4},
+			{5, 3, 5}, {7, 3, 6}
+		};
+		for (const auto &method : methods)
+		{
+			VecDbl res, sgRes;
+			DataSmoother::smooth(static_cast<SmoothMethod>(method[2]), orig, res);
+			REQUIRE(DataSmoother::savitzkyGolaySmooth(orig, sgRes, method[0], method[1]) == true);
+			REQUIRE(sgRes.size() == res.size());
+			for (size_t i = 0; i < res.size(); ++i)
+			{
+				REQUIRE(Approx(sgRes[i]).margin(1.0e-12) == res[i]);
+			}
+		}
+
+		// polynomials up to filter's order and their derivatives are kept.
+		const double spacing = 0.05;
+		VecDbl params = {0.3, -1.2, 0.8, 0.5, -0.25, 0.1, -0.02};
+		VecDbl series(301), res;
+		for (int order : {2, 4, 6})
+		{
+			for (int width : {order + 1 + order % 2, 21, 101})
+			{
+				for (int deriv = 0; deriv <= order; ++deriv)
+				{
+					auto poly = [&](double x, int d)
+					{
+						double val = 0.0;
+						for (int j = order; j >= d; --j)
+						{
+							double coeff = params[j];
+							for (int k = j; k > j - d; --k)
+							{
+								coeff *= k;
+							}
+							val = val * x + coeff;
+						}
+						return val;
+					};
+					for (size_t i = 0; i < series.size(); ++i)
+					{
+						series[i] = poly(i * spacing - 7.5, 0);
+					}
+					REQUIRE(DataSmoother::savitzkyGolaySmooth(series, res, width, order, deriv,
+					        spacing) == true);
+
+					// rounding of series is scaled up by spacing^-deriv.
+					double maxVal = 0.0;
+					for (double val : series)
+					{
+						maxVal = (std::max)(maxVal, std::fabs(val));
+					}
+					double margin = 1.0e-13 * maxVal / std::pow(spacing, deriv);
+					for (size_t i = 0; i < series.size(); ++i)
+					{
+						double real = poly(i * spacing - 7.5, deriv);
+						REQUIRE(Approx(res[i]).epsilon(1.0e-9).margin(margin) == real);
+					}
+				}
+			}
+		}
+
+		// weights are computed once, also by concurrent threads.
+		vector<const SmoothFilter *> filters(4, nullptr);
+		vector<std::thread> threads;
+		for (size_t i = 0; i < filters.size(); ++i)
+		{
+			threads.emplace_back([&filters, i]()
+			{
+				filters[i] = DataSmoother::savitzkyGolayFilter(51, 5, 1);
+			});
+		}
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+		REQUIRE(filters[0] != nullptr);
+		REQUIRE(std::count(filters.begin(), filters.end(), filters[0]) == 4);
+		REQUIRE(DataSmoother::savitzkyGolayFilter(51, 5, 1) == filters[0]);
+
+		REQUIRE(DataSmoother::savitzkyGolaySmooth(orig, res, 6, 2) == false);
+		REQUIRE(DataSmoother::savitzkyGolaySmooth(orig, res, 103, 2) == false);
+		REQUIRE(DataSmoother::savitzkyGolaySmooth(orig, res, 7, 7) == false);
+		REQUIRE(DataSmoother::savitzkyGolaySmooth(orig, res, 7, 2, 3) == false);
+		REQUIRE(DataSmoother::savitzkyGolaySmooth(orig, res, 7, 2, 1, 0.0) == false);
+	}
+	SECTION("test smoothChannels()")
+	{
+		const size_t channelNum = 13;
+		vector<const SmoothFilter *> filters = {&DataSmoother::filter(SmoothMethod::LinearN3),
+		                                        &DataSmoother::filter(SmoothMethod::CubicN7),
+		                                        DataSmoother::savitzkyGolayFilter(21, 3, 1)
+		                                       };
+		for (const SmoothFilter *filter : filters)
+		{
+			for (size_t length : {2, 7, 50})
+			{
+				// planar series of each channel, and its row-major copy.
+				VecDbl planar(length * channelNum), interleaved(planar.size());
+				for (size_t c = 0; c < channelNum; ++c)
+				{
+					for (size_t t = 0; t < length; ++t)
+					{
+						planar[c * length + t] = noise(gen);
+						interleaved[t * channelNum + c] = planar[c * length + t];
+					}
+				}
+
+				for (int threadNum : {1, 3})
+				{
+					VecDbl planarRes(planar.size()), interleavedRes(planar.size());
+					REQUIRE(DataSmoother::smoothChannels(*filter, planar.data(), length, channelNum,
+					                                     ChannelLayout::Planar, planarRes.data(), threadNum));
+					REQUIRE(DataSmoother::smoothChannels(*filter, interleaved.data(), length,
+					                                     channelNum, ChannelLayout::Interleaved,
+					                                     interleavedRes.data(), threadNum));
+					for (size_t c = 0; c < channelNum; ++c)
+					{
+						VecDbl res(length);
+						DataSmoother::smooth(*filter, planar.data() + c * length, length, res.data());
+						for (size_t t = 0; t < length; ++t)
+						{
+							REQUIRE(planarRes[c * length + t] == res[t]);
+							REQUIRE(interleavedRes[t * channelNum + c] == res[t]);
+						}
+					}
+				}
+			}
+		}
+	}
+	SECTION("test smoothRepeatedly()")
+	{
+		// series longer than a few tiles.
+		VecDbl series(10000);
+		for (auto &val : series)
+		{
+			val = noise(gen);
+		}
+
+		vector<const SmoothFilter *> filters = {&DataSmoother::filter(SmoothMethod::LinearN5),
+		                                        &DataSmoother::filter(SmoothMethod::QuadraticN7),
+		                                        DataSmoother::savitzkyGolayFilter(41, 2, 0)
+		                                       };
+		for (const SmoothFilter *filter : filters)
+		{
+			for (size_t size : {3, 5, 41, 100, 4096, 4100, 10000})
+			{
+				VecDbl res(size), fused(size);
+				std::copy(series.begin(), series.begin() + size, res.begin());
+				for (int passNum = 0; passNum <= 5; ++passNum)
+				{
+					REQUIRE(DataSmoother::smoothRepeatedly(*filter, passNum, series.data(), size,
+					                                       fused.data()));
+					REQUIRE(fused == res);
+
+					VecDbl prev = res;
+					DataSmoother::smooth(*filter, prev.data(), size, res.data());
+				}
+			}
+		}
+
+		VecDbl res, res2;
+		REQUIRE(DataSmoother::smoothRepeatedly(SmoothMethod::LinearN5, 3, orig, res));
+		DataSmoother::linearSmoothN5(orig, res2);
+		DataSmoother::linearSmoothN5(VecDbl(res2), res2);
+		DataSmoother::linearSmoothN5(VecDbl(res2), res2);
+		REQUIRE(res == res2);
+		REQUIRE(DataSmoother::smoothRepeatedly(SmoothMethod::LinearN5, -1, orig, res) == false);
+	}
+	SECTION("test movingAverage()")
+	{
+		// golden values of linear smoothing of 3, 5 and 7 elements.
+		VecDbl res, golden;
+		REQUIRE(DataSmoother::movingAverage(orig, res, 3) == true);
+		DataSmoother::linearSmoothN3(orig, golden);
+		REQUIRE(res.size() == golden.size());
+		for (size_t i = 0; i < res.size(); ++i)
+		{
+			REQUIRE(Approx(res[i]).margin(1.0e-12) == golden[i]);
+		}
+
+		REQUIRE(DataSmoother::movingAverage(orig, res, 5) == true);
+		DataSmoother::linearSmoothN5(orig, golden);
+		for (size_t i = 0; i < res.size(); ++i)
+		{
+			REQUIRE(Approx(res[i]).margin(1.0e-12) == golden[i]);
+		}
+
+		REQUIRE(DataSmoother::movingAverage(orig, res, 7) == true);
+		DataSmoother::linearSmoothN7(orig, golden);
+		for (size_t i = 0; i < res.size(); ++i)
+		{
+			REQUIRE(Approx(res[i]).margin(1.0e-12) == golden[i]);
+		}
+
+		// wide window against Savitzky-Golay filter of order 1.
+		REQUIRE(DataSmoother::movingAverage(orig, res, 41) == true);
+		REQUIRE(DataSmoother::savitzkyGolaySmooth(orig, golden, 41, 1) == true);
+		for (size_t i = 0; i < res.size(); ++i)
+		{
+			REQUIRE(Approx(res[i]).margin(1.0e-12) == golden[i]);
+		}
+
+		// running sum keeps precision over a long series with large offset.
+		VecDbl series(200000);
+		for (size_t i = 0; i < series.size(); ++i)
+		{
+			series[i] = ((i % 2 == 0) ? 1.0e8 : -1.0e8) + noise(gen) * 1.0e-3;
+		}
+		const int width = 1001;
+		REQUIRE(DataSmoother::movingAverage(series, res, width) == true);
+		for (size_t i = series.size() - 1000; i + width / 2 < series.size(); ++i)
+		{
+			double sum = 0.0;
+			for (size_t j = i - width / 2; j <= i + width / 2; ++j)
+			{
+				sum += series[j];
+			}
+			REQUIRE(Approx(res[i]).margin(1.0e-7) == sum / width);
+		}
+
+		series.assign(orig.begin(), orig.begin() + 4);
+		REQUIRE(DataSmoother::movingAverage(series, res, 5) == true);
+		REQUIRE(res == series);
+		REQUIRE(DataSmoother::movingAverage(orig, res, 4) == false);
+	}
+	SECTION("test smooth() by threads")
+	{
+		VecDbl series(100000);
+		for (auto &val : series)
+		{
+			val = noise(gen);
+		}
+
+		vector<const SmoothFilter *> filters = {&DataSmoother::filter(SmoothMethod::LinearN3),
+		                                        &DataSmoother::filter(SmoothMethod::CubicN7),
+		                                        DataSmoother::savitzkyGolayFilter(101, 4, 1)
+		                                       };
+		for (const SmoothFilter *filter : filters)
+		{
+			for (size_t size : {50, 4097, 20000, 100000})
+			{
+				VecDbl serial(size);
+				DataSmoother::smooth(*filter, series.data(), size, serial.data());
+				for (int threadNum : {0, 2, 3, 8})
+				{
+					VecDbl res(size);
+					REQUIRE(DataSmoother::smooth(*filter, series.data(), size, res.data(), threadNum));
+					REQUIRE(res == serial);
+				}
+			}
+		}
+
+		VecDbl res(orig.size());
+		SmoothFilter invalid{0, orig.data(), orig.data(), orig.data()};
+		REQUIRE(DataSmoother::smooth(invalid, orig.data(), orig.size(), res.data(), 2) == false);
+	}
+}
+
+
+TEST_CASE("test class StreamSmoother")
+{
+	std::mt19937 gen(11);
+	std::normal_distribution<double> noise(0.0, 10.0);
+	VecDbl orig(500);
+	for (auto &val : orig)
+	{
+		val = noise(gen);
+	}
+
+	vector<SmoothFilter> filters;
+	for (int m = 0; m <= static_cast<int>(SmoothMethod::CubicN7); ++m)
+	{
+		filters.emplace_back(DataSmoother::filter(static_cast<SmoothMethod>(m)));
+	}
+	filters.emplace_back(*DataSmoother::savitzkyGolayFilter(31, 4, 1));
+
+	SECTION("test chunks against the whole series")
+	{
+		for (const auto &filter : filters)
+		{
+			StreamSmoother smoother(filter);
+			for (size_t size : {0, 1, 2, 6, 7, 30, 31, 32, 100, 500})
+			{
+				VecDbl whole(size);
+				DataSmoother::smooth(filter, orig.data(), size, whole.data());
+
+				// random chunks from empty to longer than window.
+				VecDbl res;
+				size_t pos = 0;
+				while (pos < size)
+				{
+					size_t chunk = (std::min)(size - pos, size_t(gen() % 40));
+					size_t prevSize = res.size();
+					smoother.push(VecDbl(orig.begin() + pos, orig.begin() + pos + chunk), res);
+					pos += chunk;
+					REQUIRE(res.size() == prevSize + (pos - smoother.pending() - prevSize));
+					if (pos >= static_cast<size_t>(filter.width))
+					{
+						REQUIRE(smoother.pending() == static_cast<size_t>(filter.width / 2));
+					}
+				}
+				smoother.flush(res);
+				REQUIRE(smoother.pending() == 0);
+				REQUIRE(res == whole);
+			}
+		}
+	}
+
+	SECTION("test one element a time")
+	{
+		StreamSmoother smoother(SmoothMethod::CubicN7);
+		VecDbl res(orig.size() + 7), whole;
+		size_t written = 0;
+		for (double val : orig)
+		{
+			written += smoother.push(&val, 1, res.data() + written);
+		}
+		REQUIRE(written == orig.size() - 3);
+		written += smoother.flush(res.data() + written);
+		REQUIRE(written == orig.size());
+		res.resize(written);
+
+		DataSmoother::cubicSmoothN7(orig, whole);
+		REQUIRE(res == whole);
+
+		// invalid filter copies elements.
+		SmoothFilter invalid{2, orig.data(), orig.data(), orig.data()};
+		StreamSmoother copier(invalid);
+		res.clear();
+		copier.push(orig, res);
+		copier.flush(res);
+		REQUIRE(res == orig);
+	}
+}
@@ -0,0 +1,81 @@
+#include "tools/Catch/catch.hpp"
+#include "common/CommConsts.hpp"
+#include "modules/GraphAllPairs.hpp"
+#include <random>
+
+using namespace ccb;
+
+
+TEST_CASE("test class AllPairsShortestPath")
+{
+	DirectedGraphHandler::Graph graph;
+	graph.emplace_back(tuple<string, string, double> {"ver4", "ver5", 13});
+	graph.emplace_back(tuple<string, string, double> {"ver4", "ver6", 15});
+	graph.emplace_back(tuple<string, string, double> {"ver1", "ver2", 1});
+	graph.emplace_back(tuple<string, string, double> {"ver1", "ver3", 12});
+	graph.emplace_back(tuple<string, string, double> {"ver2", "ver3", 9});
+	graph.emplace_back(tuple<string, string, double> {"ver2", "ver4", 3});
+	graph.emplace_back(tuple<string, string, double> {"ver3", "ver5", 5});
+	graph.emplace_back(tuple<string, string, double> {"ver4", "ver3", 4});
+	graph.emplace_back(tuple<string, string, double> {"ver5", "ver6", 4});
+
+	DirectedGraphHandler grapher;
+	grapher.setGraph(graph);
+
+	SECTION("test runFloydWarshallAlgo()")
+	{
+		DirectedGraphHandler::GraphMatrix matrix;
+		REQUIRE(grapher.runFloydWarshallAlgo(matrix) == true);
+		REQUIRE(matrix.size() == 6);
+		REQUIRE(matrix[0] == VecDbl{0, 1, 8, 4, 13, 17});
+		REQUIRE(matrix[3] == VecDbl{_DBL_MAX, _DBL_MAX, 4, 0, 9, 13});
+		REQUIRE(matrix[5][0] == _DBL_MAX);
+		REQUIRE(matrix[5][5] == 0.0);
+
+		// negative edge is allowed, but negative cycle isn't.
+		graph.emplace_back(tuple<string, string, double> {"ver6", "ver4", -2});
+		grapher.setGraph(graph);
+		REQUIRE(grapher.runFloydWarshallAlgo(matrix) == true);
+		REQUIRE(matrix[0][3] == 4.0);
+		REQUIRE(matrix[5][2] == 2.0);
+
+		graph.emplace_back(tuple<string, string, double> {"ver5", "ver4", -20});
+		grapher.setGraph(graph);
+		REQUIRE(grapher.runFloydWarshallAlgo(matrix) == false);
+		REQUIRE(grapher.getLastStatus() == GraphStatus::NegativeCycle);
+		REQUIRE(grapher.getQueryMetrics().statusNum[static_cast<int>(GraphStatus::NegativeCycle)] == 1);
+	}
+
+	SECTION("test runFloydWarshallAlgo() against Dijkstra algorithm")
+	{
+		// several tiles with partial ones at border.
+		const int verNum = 150;
+		std::mt19937 gen(3);
+		DirectedGraphHandler::Graph graph2;
+		for (int i = 0; i < 6 * verNum; ++i)
+		{
+			graph2.emplace_back(tuple<string, string, double>
+			{std::to_string(gen() % verNum), std::to_string(gen() % verNum), gen() % 97 / 4.0});
+		}
+		grapher.setGraph(graph2);
+		ShortestPathEngine engine = grapher.getQueryEngine();
+		int size = engine.graph().verticeNum();
+
+		for (int threadNum : {1, 3})
+		{
+			VecDbl dist;
+			REQUIRE(grapher.runFloydWarshallAlgo(dist, threadNum) == true);
+			REQUIRE(dist.size() == static_cast<size_t>(size * size));
+
+			DijkstraWorkspace workspace;
+			for (int i = 0; i < size; ++i)
+			{
+				engine.DijkstraAlgo(i, -1, workspace);
+				for (int j = 0; j < size; ++j)
+				{
+					REQUIRE(Approx(dist[i * size + j]).margin(1.0e-9) == workspace.dist[j]);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,122 @@
+#include "tools/Catch/catch.hpp"
+#include "common/CommConsts.hpp"
+#include "modules/GraphContractionHierarchy.hpp"
+#include <fstream>
+#include <cstdio>
+
+using namespace ccb;
+
+
+TEST_CASE("test class ContractionHierarchy")
+{
+	// 4x4 grid graph with two-way edges and a few one-way streets.
+	DirectedGraphHandler::Graph graph;
+	for (int i = 0; i < 16; ++i)
+	{
+		string ver = "ver" + std::to_string(i);
+		if (i % 4 < 3)
+		{
+			string right = "ver" + std::to_string(i + 1);
+			graph.emplace_back(tuple<string, string, double> {ver, right, 1.0 + i % 3});
+			graph.emplace_back(tuple<string, string, double> {right, ver, 2.0});
+		}
+		if (i < 12)
+		{
+			string down = "ver" + std::to_string(i + 4);
+			graph.emplace_back(tuple<string, string, double> {ver, down, 1.5});
+			if (i % 2 == 0)
+			{
+				graph.emplace_back(tuple<string, string, double> {down, ver, 3.0});
+			}
+		}
+	}
+
+	DirectedGraphHandler grapher;
+	grapher.setGraph(graph);
+
+	vector<array<string, 2>> scenes;
+	for (int i = 0; i < 16; ++i)
+	{
+		for (int j = 0; j < 16; j += 3)
+		{
+			scenes.push_back({"ver" + std::to_string(i), "ver" + std::to_string(j)});
+		}
+	}
+
+	vector<VecStr> routes;
+	grapher.runDijkstraAlgo(scenes, 1);
+	grapher.getPathes(routes);
+	REQUIRE(routes.size() == scenes.size());
+
+	// sum of edge values along a route.
+	DirectedGraphHandler::GraphMatrix matrix;
+	grapher.getGraphMatrix(matrix);
+	auto routeLength = [&grapher, &matrix](const VecStr & route)
+	{
+		double length = 0.0;
+		for (size_t i = 1; i < route.size(); ++i)
+		{
+			length += matrix[grapher.getVerticeIndex(route[i - 1])]
+			          [grapher.getVerticeIndex(route[i])];
+		}
+		return length;
+	};
+
+	SECTION("test build() and searchPath()")
+	{
+		REQUIRE(grapher.buildContractionHierarchy() == true);
+		grapher.setSearchMode(SearchMode::ContractionHierarchy);
+
+		for (size_t i = 0; i < scenes.size(); ++i)
+		{
+			vector<VecStr> route;
+			REQUIRE(grapher.runDijkstraAlgo(scenes[i][0], scenes[i][1]) == true);
+			grapher.getPathes(route);
+			REQUIRE(route[0].front() == scenes[i][0]);
+			REQUIRE(route[0].back() == scenes[i][1]);
+			REQUIRE(Approx(routeLength(route[0])).margin(1.0e-9) == routeLength(routes[i]));
+		}
+	}
+
+	SECTION("test save() and load()")
+	{
+		REQUIRE(grapher.saveContractionHierarchy("ch_test.bin") == false);
+		REQUIRE(grapher.buildContractionHierarchy() == true);
+		REQUIRE(grapher.saveContractionHierarchy("ch_test.bin") == true);
+
+		DirectedGraphHandler grapher2;
+		grapher2.setGraph(graph);
+		REQUIRE(grapher2.loadContractionHierarchy("ch_test.bin") == true);
+		grapher2.setSearchMode(SearchMode::ContractionHierarchy);
+
+		vector<VecStr> routes2;
+		grapher2.runDijkstraAlgo(scenes, 1);
+		grapher2.getPathes(routes2);
+		REQUIRE(routes2.size() == routes.size());
+		for (size_t i = 0; i < routes.size(); ++i)
+		{
+			REQUIRE(Approx(routeLength(routes2[i])).margin(1.0e-9) == routeLength(routes[i]));
+		}
+
+		// hierarchy of another graph is rejected.
+		DirectedGraphHandler::Graph graph2 = graph;
+		std::get<2>(graph2[0]) = 10.0;
+		grapher2.setGraph(graph2);
+		REQUIRE(grapher2.loadContractionHierarchy("ch_test.bin") == false);
+		REQUIRE(grapher2.loadContractionHierarchy("not_exist.bin") == false);
+
+		// truncated or corrupted files are rejected.
+		grapher2.setGraph(graph);
+		string content;
+		{
+			std::ifstream in("ch_test.bin", std::ios::binary);
+			content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+		}
+		std::ofstream("ch_test.bin", std::ios::binary).write(content.data(), content.size() - 12);
+		REQUIRE(grapher2.loadContractionHierarchy("ch_test.bin") == false);
+		content[content.size() / 2] ^= 0x40;
+		std::ofstream("ch_test.bin", std::ios::binary).write(content.data(), content.size());
+		REQUIRE(grapher2.loadContractionHierarchy("ch_test.bin") == false);
+		std::remove("ch_test.bin");
+	}
+}
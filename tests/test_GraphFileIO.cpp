@@ -0,0 +1,260 @@
+#include "tools/Catch/catch.hpp"
+#include "common/CommConsts.hpp"
+#include "modules/GraphFileIO.hpp"
+#include <fstream>
+#include <random>
+
+using namespace ccb;
+
+
+TEST_CASE("test class EdgeListLoader")
+{
+	DirectedGraphHandler::Graph graph;
+	graph.emplace_back(tuple<string, string, double> {"ver4", "ver5", 13});
+	graph.emplace_back(tuple<string, string, double> {"ver4", "ver6", 15});
+	graph.emplace_back(tuple<string, string, double> {"ver1", "ver2", 1});
+	graph.emplace_back(tuple<string, string, double> {"ver1", "ver3", 12});
+	graph.emplace_back(tuple<string, string, double> {"ver2", "ver3", 9});
+	graph.emplace_back(tuple<string, string, double> {"ver2", "ver4", 3});
+	graph.emplace_back(tuple<string, string, double> {"ver3", "ver5", 5});
+	graph.emplace_back(tuple<string, string, double> {"ver4", "ver3", 4});
+	graph.emplace_back(tuple<string, string, double> {"ver5", "ver6", 4});
+
+	DirectedGraphHandler grapher;
+	grapher.setGraph(graph);
+	DirectedGraphHandler::GraphMatrix matrix;
+	grapher.getGraphMatrix(matrix);
+
+	SECTION("test load() of text file")
+	{
+		{
+			std::ofstream out("edges_test.csv");
+			out << "begin,end,value\n# comment line\n\n";
+			out << "ver4,ver5,13\r\nver4\tver6\t15\nver1 ver2 1\n  ver1 , ver3 , 12\n";
+			out << "ver2,ver3,9\nver2,ver4,3\nver3,ver5,5\nver4,ver3,4\nver5,ver6,4";
+		}
+
+		DirectedGraphHandler grapher2;
+		REQUIRE(grapher2.loadGraph("edges_test.csv") == true);
+		DirectedGraphHandler::GraphMatrix matrix2;
+		grapher2.getGraphMatrix(matrix2);
+		REQUIRE(matrix2 == matrix);
+
+		vector<VecStr> routes;
+		REQUIRE(grapher2.runDijkstraAlgo("ver1", "ver6") == true);
+		grapher2.getPathes(routes);
+		REQUIRE(routes[0] == VecStr{"ver1", "ver2", "ver4", "ver3", "ver5", "ver6"});
+
+		// invalid line fails the whole file and keeps current graph.
+		{
+			std::ofstream out("edges_test.csv");
+			out << "ver1,ver2,1\nver2,ver3\n";
+		}
+		REQUIRE(grapher2.loadGraph("edges_test.csv") == false);
+		REQUIRE(grapher2.loadGraph("not_exist.csv") == false);
+		REQUIRE(grapher2.getVerticeIndex("ver6") == 5);
+
+		// disconnected graph is loaded but returns `false`, as setGraph() does.
+		{
+			std::ofstream out("edges_test.csv");
+			out << "ver1,ver2,1\nver3,ver4,2\n";
+		}
+		REQUIRE(grapher2.loadGraph("edges_test.csv") == false);
+		REQUIRE(grapher2.getVerticeIndex("ver4") == 3);
+		REQUIRE(grapher2.runDijkstraAlgo("ver3", "ver4") == true);
+	}
+
+	SECTION("test load() of large file in parallel chunks")
+	{
+		// duplicated edges are overridden by the last one as in `setGraph()`.
+		std::mt19937 gen(11);
+		DirectedGraphHandler::Graph graph2;
+		{
+			std::ofstream out("edges_test.tsv");
+			for (int i = 0; i < 30000; ++i)
+			{
+				string beg = "v" + std::to_string(gen() % 2000);
+				string end = "v" + std::to_string(gen() % 2000);
+				double value = static_cast<double>(gen() % 1000) / 8.0;
+				graph2.emplace_back(tuple<string, string, double> {beg, end, value});
+				out << beg << '\t' << end << '\t' << value << '\n';
+			}
+		}
+		grapher.setGraph(graph2);
+		grapher.getGraphMatrix(matrix);
+
+		for (int threadNum : {1, 4})
+		{
+			DirectedGraphHandler grapher2;
+			REQUIRE(grapher2.loadGraph("edges_test.tsv", threadNum) == true);
+
+			DirectedGraphHandler::GraphMatrix matrix2;
+			grapher2.getGraphMatrix(matrix2);
+			REQUIRE(matrix2 == matrix);
+			REQUIRE(grapher2.getVerticeIndex("v1999") == grapher.getVerticeIndex("v1999"));
+		}
+	}
+
+	SECTION("test saveBinary() and load() of binary file")
+	{
+		vector<CsrEdge> edges = {{4, 5, 13}, {4, 6, 15}, {1, 2, 1}, {1, 3, 12}, {2, 3, 9},
+			{2, 4, 3}, {3, 5, 5}, {4, 3, 4}, {5, 6, 4}, {10, 1, 0.5}
+		};
+		REQUIRE(EdgeListLoader::saveBinary("edges_test.bin", edges) == true);
+
+		VecStr verIds;
+		vector<CsrEdge> edges2;
+		REQUIRE(EdgeListLoader::load("edges_test.bin", verIds, edges2, 2) == true);
+		REQUIRE(verIds == VecStr{"1", "10", "2", "3", "4", "5", "6"});
+		REQUIRE(edges2.size() == edges.size());
+		for (size_t i = 0; i < edges.size(); ++i)
+		{
+			REQUIRE(verIds[edges2[i].beg] == std::to_string(edges[i].beg));
+			REQUIRE(verIds[edges2[i].end] == std::to_string(edges[i].end));
+			REQUIRE(edges2[i].weight == edges[i].weight);
+		}
+
+		// truncated file is rejected.
+		{
+			std::ofstream out("edges_test.bin", std::ios::binary | std::ios::app);
+			out << "x";
+		}
+		REQUIRE(EdgeListLoader::load("edges_test.bin", verIds, edges2) == false);
+		REQUIRE(verIds.empty() == true);
+	}
+
+	std::remove("edges_test.csv");
+	std::remove("edges_test.tsv");
+	std::remove("edges_test.bin");
+}
+
+
+TEST_CASE("test class GraphSnapshot")
+{
+	// random graph with updated edges, so that rows have idle slots.
+	std::mt19937 gen(5);
+	DirectedGraphHandler::Graph graph;
+	for (int i = 0; i < 3000; ++i)
+	{
+		graph.emplace_back(tuple<string, string, double>
+		{"v" + std::to_string(gen() % 500), "v" + std::to_string(gen() % 500), gen() % 100 / 4.0});
+	}
+	DirectedGraphHandler grapher;
+	grapher.setGraph(graph);
+	grapher.addEdge("v0", "new", 1.5);
+	grapher.removeEdge(std::get<0>(graph[0]), std::get<1>(graph[0]));
+
+	DirectedGraphHandler::GraphMatrix matrix;
+	grapher.getGraphMatrix(matrix);
+
+	SECTION("test save() and load()")
+	{
+		REQUIRE(grapher.saveSnapshot("graph_test.bin") == true);
+
+		DirectedGraphHandler grapher2;
+		REQUIRE(grapher2.loadSnapshot("graph_test.bin") == true);
+		DirectedGraphHandler::GraphMatrix matrix2;
+		grapher2.getGraphMatrix(matrix2);
+		REQUIRE(matrix2 == matrix);
+		REQUIRE(grapher2.getVerticeIndex("new") == grapher.getVerticeIndex("new"));
+
+		vector<array<string, 2>> scenes;
+		for (int i = 0; i < 50; ++i)
+		{
+			scenes.push_back({"v" + std::to_string(i), "v" + std::to_string(499 - i)});
+		}
+		vector<VecStr> routes, routes2;
+		grapher.setSearchMode(SearchMode::Bidirectional);
+		grapher2.setSearchMode(SearchMode::Bidirectional);
+		for (const auto &scene : scenes)
+		{
+			REQUIRE(grapher.runDijkstraAlgo(scene[0], scene[1])
+			        == grapher2.runDijkstraAlgo(scene[0], scene[1]));
+			grapher.getPathes(routes);
+			grapher2.getPathes(routes2);
+			REQUIRE(routes == routes2);
+		}
+
+		// mapped graph is copied on modification.
+		REQUIRE(grapher2.setEdgeValue("v0", "new", 3.0) == true);
+		REQUIRE(grapher2.addEdge("new", "v1", 2.0) == true);
+		REQUIRE(grapher2.runDijkstraAlgo("v0", "v1") == true);
+		grapher2.getGraphMatrix(matrix2);
+		REQUIRE(matrix2[grapher2.getVerticeIndex("v0")][grapher2.getVerticeIndex("new")] == 3.0);
+	}
+
+#ifndef WINDOWS
+	SECTION("test save() over the file loaded from")
+	{
+		REQUIRE(grapher.saveSnapshot("graph_test.bin") == true);
+
+		// graph attached to the file stays valid after it is saved over.
+		DirectedGraphHandler grapher2;
+		REQUIRE(grapher2.loadSnapshot("graph_test.bin") == true);
+		REQUIRE(grapher2.saveSnapshot("graph_test.bin") == true);
+		DirectedGraphHandler::GraphMatrix matrix2;
+		grapher2.getGraphMatrix(matrix2);
+		REQUIRE(matrix2 == matrix);
+
+		DirectedGraphHandler grapher3;
+		REQUIRE(grapher3.loadSnapshot("graph_test.bin") == true);
+		grapher3.getGraphMatrix(matrix2);
+		REQUIRE(matrix2 == matrix);
+		REQUIRE(std::ifstream("graph_test.bin.tmp").good() == false);
+	}
+#endif
+
+	SECTION("test load() of invalid files")
+	{
+		REQUIRE(grapher.saveSnapshot("graph_test.bin") == true);
+		{
+			std::fstream io("graph_test.bin", std::ios::in | std::ios::out | std::ios::binary);
+			io.seekp(200);
+			io.put('x');
+		}
+
+		// checksum mismatch, and file failed to load keeps current graph.
+		DirectedGraphHandler grapher2;
+		grapher2.setGraph(graph);
+		REQUIRE(grapher2.loadSnapshot("graph_test.bin") == false);
+		REQUIRE(grapher2.loadSnapshot("not_exist.bin") == false);
+		REQUIRE(grapher2.getVerticeIndex("new") == -1);
+
+		{
+			std::ofstream out("graph_test.bin", std::ios::binary);
+			out << "CCBGRAPH";
+		}
+		REQUIRE(grapher2.loadSnapshot("graph_test.bin") == false);
+
+		// target out of range, even without checksum.
+		REQUIRE(grapher.saveSnapshot("graph_test.bin") == true);
+		{
+			std::fstream io("graph_test.bin", std::ios::in | std::ios::out | std::ios::binary);
+			const uint32_t targetsTag = 4;
+			uint64_t pos = 48;
+			while (true)
+			{
+				uint32_t tag = 0;
+				uint64_t length = 0;
+				io.seekg(pos);
+				io.read(reinterpret_cast<char *>(&tag), sizeof(tag));
+				io.seekg(pos + 8);
+				io.read(reinterpret_cast<char *>(&length), sizeof(length));
+				pos += 16;
+				if (tag == targetsTag)
+				{
+					break;
+				}
+				pos += (length + 7) / 8 * 8;
+			}
+			int target = 1000000;
+			io.seekp(pos + 4 * sizeof(int));
+			io.write(reinterpret_cast<const char *>(&target), sizeof(target));
+		}
+		VecStr verIds;
+		CsrGraph csrGraph, reverseGraph;
+		REQUIRE(GraphSnapshot::load("graph_test.bin", verIds, csrGraph, reverseGraph, false) == false);
+	}
+
+	std::remove("graph_test.bin");
+}
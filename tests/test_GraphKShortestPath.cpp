@@ -0,0 +1,110 @@
+#include "tools/Catch/catch.hpp"
+#include "common/CommConsts.hpp"
+#include "modules/GraphKShortestPath.hpp"
+#include <random>
+#include <functional>
+
+using namespace ccb;
+
+
+TEST_CASE("test class KShortestPathes")
+{
+	DirectedGraphHandler::Graph graph;
+	graph.emplace_back(tuple<string, string, double> {"ver4", "ver5", 13});
+	graph.emplace_back(tuple<string, string, double> {"ver4", "ver6", 15});
+	graph.emplace_back(tuple<string, string, double> {"ver1", "ver2", 1});
+	graph.emplace_back(tuple<string, string, double> {"ver1", "ver3", 12});
+	graph.emplace_back(tuple<string, string, double> {"ver2", "ver3", 9});
+	graph.emplace_back(tuple<string, string, double> {"ver2", "ver4", 3});
+	graph.emplace_back(tuple<string, string, double> {"ver3", "ver5", 5});
+	graph.emplace_back(tuple<string, string, double> {"ver4", "ver3", 4});
+	graph.emplace_back(tuple<string, string, double> {"ver5", "ver6", 4});
+
+	DirectedGraphHandler grapher;
+	grapher.setGraph(graph);
+
+	SECTION("test runYenAlgo()")
+	{
+		vector<VecStr> routes;
+		REQUIRE(grapher.runYenAlgo("ver1", "ver6", 4) == true);
+		grapher.getPathes(routes);
+		REQUIRE(routes.size() == 4);
+		REQUIRE(routes[0] == VecStr{"ver1", "ver2", "ver4", "ver3", "ver5", "ver6"});  // 17
+		REQUIRE(routes[1] == VecStr{"ver1", "ver2", "ver3", "ver5", "ver6"});  // 19
+		REQUIRE(routes[2] == VecStr{"ver1", "ver2", "ver4", "ver6"});          // 19
+		REQUIRE(routes[3] == VecStr{"ver1", "ver2", "ver4", "ver5", "ver6"});  // 21
+
+		// fewer pathes than k.
+		REQUIRE(grapher.runYenAlgo("ver3", "ver6", 5) == true);
+		grapher.getPathes(routes);
+		REQUIRE(routes.size() == 1);
+
+		REQUIRE(grapher.runYenAlgo("ver6", "ver1", 2) == false);
+		REQUIRE(grapher.runYenAlgo("ver1", "ver6", 0) == false);
+	}
+
+	SECTION("test YenAlgo() against enumerating all loopless pathes")
+	{
+		const int verNum = 12;
+		std::mt19937 gen(5);
+		DirectedGraphHandler::Graph graph2;
+		for (int i = 0; i < 4 * verNum; ++i)
+		{
+			// a few negative values without negative cycle: u < v only.
+			int beg = gen() % verNum, end = gen() % verNum;
+			double value = (beg < end && gen() % 4 == 0) ? -1.0 : gen() % 9 + 1.0;
+			graph2.emplace_back(tuple<string, string, double>
+			{"v" + std::to_string(beg), "v" + std::to_string(end), value});
+		}
+		grapher.setGraph(graph2);
+		ShortestPathEngine engine = grapher.getQueryEngine();
+		const CsrGraph &csrGraph = engine.graph();
+		int size = csrGraph.verticeNum();
+
+		KShortestPathes searcher(engine);
+		for (int beg = 0; beg < size; ++beg)
+		{
+			for (int end = 0; end < size; end += 3)
+			{
+				// lengths of all loopless pathes by depth first search.
+				VecDbl allLengths;
+				VecBool isVisited(size, false);
+				std::function<void(int, double)> visit = [&](int ver, double length)
+				{
+					if (ver == end)
+					{
+						allLengths.emplace_back(length);
+						return;
+					}
+					isVisited[ver] = true;
+					for (int e = csrGraph.edgeBegin(ver); e < csrGraph.edgeEnd(ver); ++e)
+					{
+						if (!isVisited[csrGraph.target(e)])
+						{
+							visit(csrGraph.target(e), length + csrGraph.weight(e));
+						}
+					}
+					isVisited[ver] = false;
+				};
+				visit(beg, 0.0);
+				std::sort(allLengths.begin(), allLengths.end());
+
+				vector<VecInt> routes;
+				VecDbl lengths;
+				const int k = 15;
+				REQUIRE(searcher.YenAlgo(beg, end, k, routes, lengths) == !allLengths.empty());
+				REQUIRE(routes.size() == (std::min)(allLengths.size(), size_t(k)));
+				for (size_t i = 0; i < routes.size(); ++i)
+				{
+					REQUIRE(Approx(lengths[i]).margin(1.0e-9) == allLengths[i]);
+					REQUIRE(routes[i].front() == beg);
+					REQUIRE(routes[i].back() == end);
+
+					VecInt vers = routes[i];
+					std::sort(vers.begin(), vers.end());
+					REQUIRE(std::unique(vers.begin(), vers.end()) == vers.end());
+				}
+			}
+		}
+	}
+}
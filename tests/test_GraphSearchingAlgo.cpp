@@ -1,6 +1,8 @@
 #include "tools/Catch/catch.hpp"
 #include "common/CommConsts.hpp"
 #include "modules/GraphSearchingAlgo.hpp"
+#include <random>
+#include <map>
 
 using namespace ccb;
 
@@ -122,6 +124,412 @@ TEST_CASE("test class DirectedGraphHandler")
 		REQUIRE(routes[1][3] == "ver3");
 	}
 
+	SECTION("test runDijkstraAlgo(const string&)")
+	{
+		vector<VecStr> routes, routes2;
+
+		// pathes from source vertice to all reachable vertices.
+		bool status = grapher.runDijkstraAlgo("ver2");
+		grapher.getPathes(routes);
+		CHECK(status == true);
+		REQUIRE(routes.size() == 4);
+		REQUIRE(routes[0] == VecStr{"ver2", "ver4", "ver3"});
+		REQUIRE(routes[1] == VecStr{"ver2", "ver4"});
+		REQUIRE(routes[2] == VecStr{"ver2", "ver4", "ver3", "ver5"});
+		REQUIRE(routes[3] == VecStr{"ver2", "ver4", "ver3", "ver5", "ver6"});
+
+		// answer batch queries from cached shortest path trees.
+		grapher.runDijkstraAlgo(scenes);
+		grapher.getPathes(routes);
+		grapher.setPathTreeCapacity(1);
+		grapher.runDijkstraAlgo(scenes);
+		grapher.getPathes(routes2);
+		REQUIRE(routes2.size() == 5);
+		REQUIRE(routes2 == routes);
+		REQUIRE(routes[2] == VecStr{"ver1", "ver2", "ver4", "ver3", "ver5", "ver6"});
+		REQUIRE(routes[3] == VecStr{"ver2", "ver4", "ver3", "ver5"});
+	}
+
+	SECTION("test runDijkstraAlgo(const vector<array<string, 2>>&, int)")
+	{
+		vector<VecStr> routes, routes2;
+
+		grapher.runDijkstraAlgo(scenes);
+		grapher.getPathes(routes);
+		bool status = grapher.runDijkstraAlgo(scenes, 3);
+		grapher.getPathes(routes2);
+		CHECK(status == true);
+		REQUIRE(routes2 == routes);
+
+		// shared engine answers queries by vertices index.
+		ShortestPathEngine engine = grapher.getQueryEngine();
+		int ver1 = grapher.getVerticeIndex("ver1");
+		int ver6 = grapher.getVerticeIndex("ver6");
+		vector<VecInt> pathes = engine.searchPathes({{ver1, ver6}, {ver6, ver1}}, 2);
+		REQUIRE(pathes.size() == 2);
+		REQUIRE(pathes[0].size() == 6);
+		REQUIRE(pathes[1].empty() == true);
+		REQUIRE(grapher.getVerticeIndex("ver7") == -1);
+
+		// one error scene in set of scenes would destroy all.
+		scenes.emplace_back(scene3);
+		status = grapher.runDijkstraAlgo(scenes, 3);
+		grapher.getPathes(routes);
+		CHECK(status == false);
+		REQUIRE(routes.empty() == true);
+	}
+
+	SECTION("test getPathResults()")
+	{
+		// costs: 1, 8, 17, 12, 13.
+		for (int threadNum : {0, 2})
+		{
+			bool status = (threadNum == 0) ? grapher.runDijkstraAlgo(scenes)
+			              : grapher.runDijkstraAlgo(scenes, threadNum);
+			REQUIRE(status == true);
+
+			const PathStore &pathes = grapher.getPathResults();
+			REQUIRE(pathes.size() == 5);
+			REQUIRE(pathes[0].size() == 2);
+			REQUIRE(pathes[0].name(1) == "ver2");
+			REQUIRE(pathes[2].size() == 6);
+			REQUIRE(pathes[2].name(0) == "ver1");
+			REQUIRE(pathes[2].name(3) == "ver3");
+			REQUIRE(pathes[2][5] == grapher.getVerticeIndex("ver6"));
+			REQUIRE(pathes[1].cost() == 8.0);
+			REQUIRE(pathes[2].cost() == 17.0);
+			REQUIRE(pathes[3].cost() == 12.0);
+			REQUIRE(pathes[4].cost() == 13.0);
+		}
+
+		REQUIRE(grapher.runDijkstraAlgo("ver2", "ver6") == true);
+		REQUIRE(grapher.getPathResults().size() == 1);
+		REQUIRE(grapher.getPathResults()[0].cost() == 16.0);
+		REQUIRE(grapher.runDijkstraAlgo("ver4") == true);
+		REQUIRE(grapher.getPathResults().size() == 3);
+		REQUIRE(grapher.getPathResults()[2].name(3) == "ver6");
+
+		// copied or moved handler names pathes by its own vertices.
+		auto source = std::make_unique<DirectedGraphHandler>(grapher);
+		DirectedGraphHandler copied(*source), moved(std::move(*source));
+		source.reset();
+		REQUIRE(copied.getPathResults()[2].name(3) == "ver6");
+		REQUIRE(moved.getPathResults()[2].name(3) == "ver6");
+		copied = moved;
+		REQUIRE(copied.getPathResults()[2].name(0) == "ver4");
+
+		// unreachable pair has empty path of INF cost.
+		PathStore pathes;
+		int ver1 = grapher.getVerticeIndex("ver1");
+		int ver6 = grapher.getVerticeIndex("ver6");
+		grapher.getQueryEngine().searchPathes({{ver6, ver1}, {ver1, ver6}}, pathes);
+		REQUIRE(pathes.size() == 2);
+		REQUIRE(pathes[0].size() == 0);
+		REQUIRE(pathes[0].cost() == _DBL_MAX);
+		REQUIRE(VecInt(pathes[1].begin(), pathes[1].end()) == VecInt{0, 1, 3, 2, 4, 5});
+		REQUIRE(pathes[1].name(0).empty() == true);  // no names table.
+	}
+
+	SECTION("test setSearchMode()")
+	{
+		vector<VecStr> route1, route2, route3;
+
+		grapher.resetSearchStats();
+		grapher.runDijkstraAlgo(scene1[0], scene1[1]);
+		grapher.getPathes(route1);
+		SearchStats stats1 = grapher.getSearchStats();
+		CHECK(stats1.queryNum == 1);
+
+		grapher.setSearchMode(SearchMode::Bidirectional);
+		grapher.resetSearchStats();
+		grapher.runDijkstraAlgo(scene1[0], scene1[1]);
+		grapher.getPathes(route2);
+		REQUIRE(route2 == route1);
+		CHECK(grapher.getSearchStats().settledVertices <= stats1.settledVertices);
+
+		// parallel batch queries count in stats as well.
+		grapher.resetSearchStats();
+		vector<array<string, 2>> pairs{{scene1[0], scene1[1]}, {scene1[1], scene1[0]}};
+		grapher.runDijkstraAlgo(pairs, 2);
+		CHECK(grapher.getSearchStats().queryNum == 2);
+
+		// zero heuristic is admissible.
+		grapher.setSearchMode(SearchMode::AStar);
+		grapher.setHeuristic([](int, int) {return 0.0;});
+		grapher.runDijkstraAlgo(scene1[0], scene1[1]);
+		grapher.getPathes(route3);
+		REQUIRE(route3 == route1);
+
+		// no path between two vertices in a directed graph.
+		grapher.setSearchMode(SearchMode::Bidirectional);
+		bool status = grapher.runDijkstraAlgo(scene3[0], scene3[1]);
+		CHECK(status == false);
+	}
+
+	SECTION("test runDijkstraAlgo() with non-integral edge values")
+	{
+		vector<VecStr> routes;
+
+		// binary heap is used instead of radix heap.
+		DirectedGraphHandler::Graph graph2 = graph;
+		for (auto &edge : graph2)
+		{
+			std::get<2>(edge) += 0.5;
+		}
+		grapher.setGraph(graph2);
+		grapher.runDijkstraAlgo(scenes);
+		grapher.getPathes(routes);
+		REQUIRE(routes.size() == 5);
+		REQUIRE(routes[2] == VecStr{"ver1", "ver2", "ver4", "ver3", "ver5", "ver6"});
+		REQUIRE(routes[4] == VecStr{"ver4", "ver3", "ver5", "ver6"});
+	}
+
+	SECTION("test addEdge(), removeEdge() and setEdgeValue()")
+	{
+		vector<VecStr> routes;
+
+		// cache trees from ver1, ver2 and ver4.
+		grapher.runDijkstraAlgo(scenes);
+		ShortestPathEngine engine = grapher.getQueryEngine();
+
+		// shorter edge invalidates trees it improves.
+		REQUIRE(grapher.setEdgeValue("ver1", "ver3", 2) == true);
+		grapher.runDijkstraAlgo(scenes);
+		grapher.getPathes(routes);
+		REQUIRE(routes[1] == VecStr{"ver1", "ver3"});
+		REQUIRE(routes[2] == VecStr{"ver1", "ver3", "ver5", "ver6"});
+		REQUIRE(routes[4] == VecStr{"ver4", "ver3", "ver5", "ver6"});
+
+		// new edge and removed edge.
+		REQUIRE(grapher.addEdge("ver1", "ver6", 1) == true);
+		REQUIRE(grapher.addEdge("ver1", "ver6", 1) == false);
+		grapher.runDijkstraAlgo(scene1[0], scene1[1]);
+		grapher.getPathes(routes);
+		REQUIRE(routes[0] == VecStr{"ver1", "ver6"});
+
+		REQUIRE(grapher.removeEdge("ver1", "ver6") == true);
+		REQUIRE(grapher.removeEdge("ver1", "ver6") == false);
+		REQUIRE(grapher.removeEdge("ver1", "ver9") == false);
+		grapher.runDijkstraAlgo(scene1[0], scene1[1]);
+		grapher.getPathes(routes);
+		REQUIRE(routes[0] == VecStr{"ver1", "ver3", "ver5", "ver6"});
+
+		// longer edge invalidates trees containing it.
+		REQUIRE(grapher.setEdgeValue("ver4", "ver3", 20) == true);
+		REQUIRE(grapher.setEdgeValue("ver3", "ver4", 20) == false);
+		grapher.runDijkstraAlgo(scenes);
+		grapher.getPathes(routes);
+		REQUIRE(routes[3] == VecStr{"ver2", "ver3", "ver5"});
+		REQUIRE(routes[4] == VecStr{"ver4", "ver6"});
+
+		// new vertices.
+		REQUIRE(grapher.addVertice("ver1") == false);
+		REQUIRE(grapher.addVertice("ver9") == true);
+		REQUIRE(grapher.runDijkstraAlgo("ver1", "ver9") == false);
+		REQUIRE(grapher.addEdge("ver6", "ver7", 2) == true);
+		REQUIRE(grapher.runDijkstraAlgo("ver4", "ver7") == true);
+		grapher.getPathes(routes);
+		REQUIRE(routes[0] == VecStr{"ver4", "ver6", "ver7"});
+		REQUIRE(grapher.getVerticeIndex("ver9") == 6);
+		REQUIRE(grapher.getVerticeIndex("ver7") == 7);
+
+		// engine shared before updates keeps its snapshot.
+		REQUIRE(engine.graph().verticeNum() == 6);
+		REQUIRE(Approx(engine.graph().findWeight(0, 2)).margin(_DBL_EPSILON) == 12.0);
+	}
+
+	SECTION("test incremental updates against rebuilding")
+	{
+		// random updates on a random graph, compared with a rebuilt graph.
+		const int verNum = 40;
+		std::mt19937 gen(7);
+		std::uniform_int_distribution<int> verDist(0, verNum - 1);
+		std::uniform_int_distribution<int> valueDist(1, 20);
+
+		std::map<array<int, 2>, double> edges;
+		for (int i = 0; i < 4 * verNum; ++i)
+		{
+			edges[ {verDist(gen), verDist(gen)}] = valueDist(gen);
+		}
+		auto toGraph = [&edges]()
+		{
+			DirectedGraphHandler::Graph graph2;
+			for (int i = 0; i < verNum; ++i)
+			{
+				graph2.emplace_back(tuple<string, string, double>
+				{"v" + std::to_string(i), "v" + std::to_string(i), 0.0});
+			}
+			for (const auto &edge : edges)
+			{
+				graph2.emplace_back(tuple<string, string, double>
+				{"v" + std::to_string(edge.first[0]), "v" + std::to_string(edge.first[1]), edge.second});
+			}
+			return graph2;
+		};
+
+		DirectedGraphHandler updated;
+		updated.setGraph(toGraph());
+		updated.setPathTreeCapacity(verNum);
+		for (int step = 0; step < 200; ++step)
+		{
+			array<int, 2> edge = {verDist(gen), verDist(gen)};
+			string beg = "v" + std::to_string(edge[0]);
+			string end = "v" + std::to_string(edge[1]);
+			double value = valueDist(gen);
+			if (edge[0] == edge[1])
+			{
+				continue;
+			}
+			if (edges.count(edge) < 1)
+			{
+				REQUIRE(updated.addEdge(beg, end, value) == true);
+				edges[edge] = value;
+			}
+			else if (step % 3 == 0)
+			{
+				REQUIRE(updated.removeEdge(beg, end) == true);
+				edges.erase(edge);
+			}
+			else
+			{
+				REQUIRE(updated.setEdgeValue(beg, end, value) == true);
+				edges[edge] = value;
+			}
+
+			DirectedGraphHandler rebuilt;
+			rebuilt.setGraph(toGraph());
+			DirectedGraphHandler::GraphMatrix matrix;
+			rebuilt.getGraphMatrix(matrix);
+
+			string source = "v" + std::to_string(step % 5);
+			vector<VecStr> routes, routes2;
+			REQUIRE(updated.runDijkstraAlgo(source) == rebuilt.runDijkstraAlgo(source));
+			updated.getPathes(routes);
+			rebuilt.getPathes(routes2);
+			REQUIRE(routes.size() == routes2.size());
+			for (size_t i = 0; i < routes.size(); ++i)
+			{
+				double length = 0.0, length2 = 0.0;
+				for (size_t j = 1; j < routes[i].size(); ++j)
+				{
+					length += matrix[rebuilt.getVerticeIndex(routes[i][j - 1])]
+					          [rebuilt.getVerticeIndex(routes[i][j])];
+				}
+				for (size_t j = 1; j < routes2[i].size(); ++j)
+				{
+					length2 += matrix[rebuilt.getVerticeIndex(routes2[i][j - 1])]
+					           [rebuilt.getVerticeIndex(routes2[i][j])];
+				}
+				REQUIRE(routes[i].back() == routes2[i].back());
+				REQUIRE(Approx(length).margin(1.0e-9) == length2);
+			}
+		}
+	}
+
+	SECTION("test negative edge values")
+	{
+		graph.emplace_back(tuple<string, string, double> {"ver6", "ver4", -2});
+		graph.emplace_back(tuple<string, string, double> {"ver5", "ver2", -6});
+		grapher.setGraph(graph);
+		REQUIRE(grapher.getQueryEngine().hasNegativeEdge() == true);
+		REQUIRE(grapher.getQueryEngine().isReweighted() == true);
+
+		vector<VecStr> routes;
+		REQUIRE(grapher.runDijkstraAlgo("ver6", "ver2") == true);
+		grapher.getPathes(routes);
+		REQUIRE(routes[0] == VecStr{"ver6", "ver4", "ver3", "ver5", "ver2"});
+
+		vector<array<string, 2>> pairs{{"ver3", "ver2"}, {"ver6", "ver3"}, {"ver1", "ver6"}};
+		REQUIRE(grapher.runDijkstraAlgo(pairs) == true);
+		grapher.getPathes(routes);
+		REQUIRE(routes[0] == VecStr{"ver3", "ver5", "ver2"});
+		REQUIRE(routes[1] == VecStr{"ver6", "ver4", "ver3"});
+		REQUIRE(routes[2] == VecStr{"ver1", "ver2", "ver4", "ver3", "ver5", "ver6"});
+		REQUIRE(grapher.runDijkstraAlgo(pairs, 2) == true);
+		grapher.getPathes(routes);
+		REQUIRE(routes[1] == VecStr{"ver6", "ver4", "ver3"});
+
+		// negative cycle fails queries until it's broken.
+		REQUIRE(grapher.setEdgeValue("ver5", "ver2", -20) == true);
+		REQUIRE(grapher.runDijkstraAlgo("ver1", "ver6") == false);
+		REQUIRE(grapher.setEdgeValue("ver5", "ver2", -6) == true);
+		REQUIRE(grapher.runDijkstraAlgo("ver1", "ver6") == true);
+
+		// potentials broken by an update are recomputed on the update.
+		REQUIRE(grapher.setEdgeValue("ver4", "ver3", -1) == true);
+		ShortestPathEngine engine = grapher.getQueryEngine();
+		REQUIRE(engine.isReweighted() == true);
+
+		VecDbl matrix;
+		REQUIRE(grapher.runFloydWarshallAlgo(matrix) == true);
+		DijkstraWorkspace workspace;
+		vector<array<int, 2>> indPairs;
+		for (int i = 0; i < 6; ++i)
+		{
+			engine.DijkstraAlgo(i, -1, workspace);
+			for (int j = 0; j < 6; ++j)
+			{
+				REQUIRE(Approx(workspace.dist[j]).margin(1.0e-9) == matrix[i * 6 + j]);
+				indPairs.push_back({i, j});
+			}
+		}
+		vector<VecInt> indRoutes = engine.searchPathes(indPairs, 2);
+		REQUIRE(indRoutes[5 * 6 + 1] == VecInt{5, 3, 2, 4, 1});
+		REQUIRE(indRoutes[5 * 6 + 0].empty() == true);
+	}
+
+	SECTION("test Johnson reweighting against Floyd-Warshall algorithm")
+	{
+		// random potentials p make w + p(u) - p(v) free of negative cycle.
+		const int verNum = 60;
+		std::mt19937 gen(11);
+		VecDbl potentials(verNum);
+		for (auto &value : potentials)
+		{
+			value = static_cast<double>(gen() % 40);
+		}
+		DirectedGraphHandler::Graph graph2;
+		for (int i = 0; i < 5 * verNum; ++i)
+		{
+			int beg = gen() % verNum, end = gen() % verNum;
+			graph2.emplace_back(tuple<string, string, double>
+			{
+				"v" + std::to_string(beg), "v" + std::to_string(end),
+				gen() % 10 + potentials[end] - potentials[beg]
+			});
+		}
+		DirectedGraphHandler grapher2;
+		grapher2.setGraph(graph2);
+		ShortestPathEngine engine = grapher2.getQueryEngine();
+		REQUIRE(engine.hasNegativeEdge() == true);
+		REQUIRE(engine.isReweighted() == true);
+
+		VecDbl matrix;
+		REQUIRE(grapher2.runFloydWarshallAlgo(matrix) == true);
+		int size = engine.graph().verticeNum();
+		DijkstraWorkspace workspace, workspace2;
+		for (int i = 0; i < size; ++i)
+		{
+			engine.DijkstraAlgo(i, -1, workspace);
+			REQUIRE(engine.BellmanFordAlgo(i, workspace2) == true);
+			for (int j = 0; j < size; ++j)
+			{
+				REQUIRE(Approx(workspace.dist[j]).margin(1.0e-9) == matrix[i * size + j]);
+				REQUIRE(Approx(workspace2.dist[j]).margin(1.0e-9) == matrix[i * size + j]);
+			}
+		}
+
+		// a negative cycle is found once graph is set.
+		graph2.emplace_back(tuple<string, string, double> {"v1", "v2", -100.0});
+		graph2.emplace_back(tuple<string, string, double> {"v2", "v1", -100.0});
+		grapher2.setGraph(graph2);
+		REQUIRE(grapher2.getQueryEngine().hasNegativeCycle() == true);
+		REQUIRE(grapher2.runDijkstraAlgo("v1") == false);
+		REQUIRE(grapher2.getQueryEngine().BellmanFordAlgo(1, workspace2) == false);
+		vector<VecInt> indRoutes = grapher2.getQueryEngine().searchPathes({{1, 1}, {1, 2}, {3, 3}});
+		REQUIRE(indRoutes == vector<VecInt>(3));
+	}
+
 	SECTION("test runDijkstraAlgo() failure scenes")
 	{
 		vector<VecStr> route1, route2, routes;
@@ -147,6 +555,39 @@ TEST_CASE("test class DirectedGraphHandler")
 
 	}
 
+	SECTION("test getLastStatus() and getQueryMetrics()")
+	{
+		grapher.resetQueryMetrics();
+		REQUIRE(grapher.runDijkstraAlgo(scene1[0], scene1[1]) == true);
+		REQUIRE(grapher.getLastStatus() == GraphStatus::Ok);
+		REQUIRE(grapher.runDijkstraAlgo(scene3[0], scene3[1]) == false);
+		REQUIRE(grapher.getLastStatus() == GraphStatus::NoPath);
+		REQUIRE(grapher.runDijkstraAlgo(scene4[0], scene4[1]) == false);
+		REQUIRE(grapher.getLastStatus() == GraphStatus::InvalidVertice);
+		REQUIRE(grapher.runYenAlgo(scene1[0], scene1[1], 0) == false);
+		REQUIRE(grapher.getLastStatus() == GraphStatus::InvalidArgument);
+
+		scenes.emplace_back(scene3);
+		REQUIRE(grapher.runDijkstraAlgo(scenes) == false);
+		REQUIRE(grapher.runDijkstraAlgo(scenes, 2) == false);
+		REQUIRE(grapher.getLastStatus() == GraphStatus::NoPath);
+
+		const QueryMetrics &metrics = grapher.getQueryMetrics();
+		REQUIRE(metrics.queryNum == 6);
+		REQUIRE(metrics.failedNum == 5);
+		REQUIRE(metrics.statusNum[static_cast<int>(GraphStatus::NoPath)] == 3);
+		REQUIRE(metrics.statusNum[static_cast<int>(GraphStatus::InvalidVertice)] == 1);
+		REQUIRE(std::string(graphStatusName(GraphStatus::NoPath)) == "no_path");
+
+		DirectedGraphHandler empty;
+		REQUIRE(empty.runDijkstraAlgo("ver1") == false);
+		REQUIRE(empty.getLastStatus() == GraphStatus::EmptyGraph);
+
+		grapher.setLogLevel(LogLevel::Error);
+		REQUIRE(grapher.runDijkstraAlgo(scene3[0], scene3[1]) == false);
+		grapher.setLogLevel(LogLevel::Off);
+	}
+
 	// SECTION("test displayXXX()")
 	// {
 	//     bool status = true;
@@ -162,6 +603,54 @@ TEST_CASE("test class DirectedGraphHandler")
 	//     grapher.displayPathes();
 	// }
 
+	SECTION("test getXXXConnectedComponents()")
+	{
+		vector<VecStr> components;
+
+		grapher.getWeaklyConnectedComponents(components);
+		REQUIRE(components.size() == 1);
+		REQUIRE(components[0].size() == 6);
+
+		// acyclic graph has each vertice as a strong component.
+		grapher.getStronglyConnectedComponents(components);
+		REQUIRE(components.size() == 6);
+
+		DirectedGraphHandler::Graph graph2 = graph;
+		graph2.emplace_back(tuple<string, string, double> {"ver6", "ver4", 1});
+		graph2.emplace_back(tuple<string, string, double> {"ver7", "ver8", 1});
+		grapher.setGraph(graph2);
+		grapher.getWeaklyConnectedComponents(components);
+		REQUIRE(components.size() == 2);
+		REQUIRE(components[1] == VecStr{"ver7", "ver8"});
+
+		grapher.getStronglyConnectedComponents(components);
+		auto iter = std::find_if(components.begin(), components.end(), [](const VecStr & comp)
+		{
+			return comp.size() > 1;
+		});
+		REQUIRE(iter != components.end());
+		REQUIRE(*iter == VecStr{"ver3", "ver4", "ver5", "ver6"});
+		REQUIRE(components.size() == 5);
+	}
+
+	SECTION("test isGraphConnected() on long chain")
+	{
+		// deep chain would overflow a recursive search.
+		DirectedGraphHandler::Graph chain;
+		for (int i = 0; i < 200000; ++i)
+		{
+			chain.emplace_back(tuple<string, string, double>
+			{
+				std::to_string(i), std::to_string(i + 1), 1.0
+			});
+		}
+		CHECK(grapher.setGraph(chain) == true);
+
+		vector<VecStr> components;
+		grapher.getStronglyConnectedComponents(components);
+		REQUIRE(components.size() == 200001);
+	}
+
 	SECTION("test isGraphConnected()")
 	{
 		bool status = true;